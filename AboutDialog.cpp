@@ -20,6 +20,8 @@
 // Project
 #include <AboutDialog.h>
 #include <Utils.h>
+#include <Metrics.h>
+#include <ProcessAccounting.h>
 
 // Qt
 #include <QDesktopServices>
@@ -51,6 +53,13 @@ AboutDialog::AboutDialog(const Utils::Configuration &config, QWidget *parent, Qt
   m_qtVersion->setText(tr("version %1").arg(qVersion()));
   m_copy->setText(COPYRIGHT.arg(QDateTime::currentDateTime().date().year()));
 
+  ProcessAccounting::Usage usage;
+  usage.cpuMsec = Metrics::value("process cpu msec");
+  usage.peakMemory = Metrics::value("process peak memory");
+  usage.readBytes = Metrics::value("process read bytes");
+  usage.writeBytes = Metrics::value("process write bytes");
+  usage.contextSwitches = Metrics::value("process context switches");
+  m_usage->setText(tr("curl processes: %1").arg(usage.toText()));
 
   QObject::connect(m_kofiLabel, &Utils::ClickableHoverLabel::clicked,
                    [this](){ QDesktopServices::openUrl(QUrl{"https://ko-fi.com/felixdelaspozas"}); });
@@ -19,11 +19,16 @@
 
 // Project
 #include <AddItemDialog.h>
+#include <UrlGlob.h>
+
+// Qt
 #include <QCloseEvent>
 #include <QMessageBox>
 #include <QHostAddress>
 #include <QAbstractSocket>
-#include <QHostAddress>
+
+// C++
+#include <memory>
 
 //----------------------------------------------------------------------------
 AddItemDialog::AddItemDialog(QWidget *parent, Qt::WindowFlags f)
@@ -32,6 +37,7 @@ AddItemDialog::AddItemDialog(QWidget *parent, Qt::WindowFlags f)
   setupUi(this);
 
   connect(m_serverIP, SIGNAL(textChanged(const QString &)), this, SLOT(onServerTextChanged()));
+  connect(m_usePool, SIGNAL(toggled(bool)), this, SLOT(onUsePoolChanged()));
 }
 
 //----------------------------------------------------------------------------
@@ -46,6 +52,14 @@ void AddItemDialog::setItem(const Utils::ItemInformation *item)
     const int index = item->protocol == Utils::Protocol::SOCKS4 ? 0 : (item->protocol == Utils::Protocol::NONE ? 2 : 1);
     m_protocolCombo->setCurrentIndex(index);
     m_name->setText(item->outputName);
+    m_usePool->setChecked(item->usePool);
+    m_priority->setCurrentIndex(static_cast<int>(item->priority));
+    m_background->setChecked(item->background);
+    m_extract->setChecked(item->extract);
+
+    QStringList mirrors;
+    for(const auto &mirror: item->mirrors) mirrors << mirror.toString();
+    m_mirrors->setText(mirrors.join(' '));
   }
 }
 
@@ -62,21 +76,83 @@ Utils::ItemInformation* AddItemDialog::getItem() const
                                          static_cast<Utils::Protocol>(m_protocolCombo->currentIndex()), 
                                          m_name->text());
 
-  if (item->outputName.isEmpty())
+  // the generated items take their names from the pattern.
+  if (item->outputName.isEmpty() && !isPattern())
     item->outputName = item->url.fileName();
 
+  for(const auto &mirror: m_mirrors->text().split(' ', Qt::SkipEmptyParts))
+  {
+    const QUrl mirrorUrl(mirror);
+    if(mirrorUrl != item->url && !item->mirrors.contains(mirrorUrl))
+      item->mirrors << mirrorUrl;
+  }
+
+  item->priority = static_cast<Utils::Priority>(m_priority->currentIndex());
+  item->background = m_background->isChecked();
+  item->extract = m_extract->isChecked();
+
+  // the proxy is assigned by the pool.
+  item->usePool = m_usePool->isChecked();
+  if(item->usePool)
+  {
+    item->server.clear();
+    item->port = 0;
+    item->protocol = Utils::Protocol::NONE;
+  }
+
   return item;                                
 }
 
 //----------------------------------------------------------------------------
 void AddItemDialog::closeEvent(QCloseEvent *e)
 {
-  const auto item = Utils::ItemInformation(QUrl(m_url->text()),
-                                           m_serverIP->text(),
+  auto item = Utils::ItemInformation(QUrl(m_url->text()),
+                                           m_usePool->isChecked() ? QString() : m_serverIP->text(),
                                            m_serverPort->text().toUInt(),
                                            static_cast<Utils::Protocol>(m_protocolCombo->currentIndex()), 
                                            m_name->text());
 
+  for(const auto &mirror: m_mirrors->text().split(' ', Qt::SkipEmptyParts))
+    item.mirrors << QUrl(mirror);
+
+  // validate the first item of the pattern.
+  if(m_pattern->isChecked())
+  {
+    UrlGlob glob(pattern(), item);
+    if(!glob.isValid())
+    {
+      e->setAccepted(false);
+      e->ignore();
+
+      QMessageBox msgBox(this);
+      msgBox.setWindowTitle("Item information");
+      msgBox.setStandardButtons(QMessageBox::Button::Ok);
+      msgBox.setText(QString("The url pattern is not valid. %1").arg(glob.error()));
+      msgBox.exec();
+
+      return;
+    }
+
+    // the same name for all the urls would write them to the same file.
+    if(glob.count() > 1 && !item.outputName.isEmpty() && !UrlGlob::hasNameReference(item.outputName))
+    {
+      e->setAccepted(false);
+      e->ignore();
+
+      QMessageBox msgBox(this);
+      msgBox.setWindowTitle("Item information");
+      msgBox.setStandardButtons(QMessageBox::Button::Ok);
+      msgBox.setText("The output name of a pattern must reference its values with '#n' or be empty.");
+      msgBox.exec();
+
+      return;
+    }
+
+    const std::unique_ptr<Utils::ItemInformation> first{glob.next()};
+    item.url = first->url;
+    item.outputName = first->outputName;
+  }
+
   if(!item.isValid())
   {
     e->setAccepted(false);
@@ -97,7 +173,14 @@ void AddItemDialog::closeEvent(QCloseEvent *e)
 //----------------------------------------------------------------------------
 void AddItemDialog::onServerTextChanged()
 {
-  const auto enabled = !m_serverIP->text().isEmpty() && !QHostAddress(m_serverIP->text()).isNull();
+  const auto enabled = !m_usePool->isChecked() && !m_serverIP->text().isEmpty() && !QHostAddress(m_serverIP->text()).isNull();
   m_serverPort->setEnabled(enabled);
   m_protocolCombo->setEnabled(enabled);
 }
+
+//----------------------------------------------------------------------------
+void AddItemDialog::onUsePoolChanged()
+{
+  m_serverIP->setEnabled(!m_usePool->isChecked());
+  onServerTextChanged();
+}
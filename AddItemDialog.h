@@ -60,6 +60,18 @@ class AddItemDialog
      */
     Utils::ItemInformation* getItem() const;
 
+    /**
+     * @brief Returns true if the url is a pattern that generates several items.
+     */
+    bool isPattern() const
+    { return m_pattern->isChecked(); }
+
+    /**
+     * @brief Returns the url pattern text.
+     */
+    QString pattern() const
+    { return m_url->text().trimmed(); }
+
   protected:
     void closeEvent(QCloseEvent *) override;
 
@@ -68,6 +80,11 @@ class AddItemDialog
      * @brief Modifies en UI when the text changes. 
      */
     void onServerTextChanged();
+
+    /**
+     * @brief Enables or disables the proxy server widgets when the proxy pool checkbox changes.
+     */
+    void onUsePoolChanged();
 };
 
 #endif
\ No newline at end of file
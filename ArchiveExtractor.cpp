@@ -0,0 +1,280 @@
+/*
+ File: ArchiveExtractor.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ArchiveExtractor.h>
+#include <Metrics.h>
+#include <Tracer.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+
+// C++
+#include <algorithm>
+
+const int FEED_INTERVAL = 100;                  // milliseconds between reads of the file.
+const qint64 READ_SIZE = 1024 * 1024;           // bytes read from the file at once.
+const qint64 MAX_PENDING = 16 * 1024 * 1024;    // bytes written to the extractor and not yet consumed.
+const int MAX_ERROR_TEXT = 4096;                // bytes of error text kept.
+const int VERSION_TIMEOUT = 5000;               // milliseconds to wait for the version of the extractor.
+
+const QList<std::pair<QString, ArchiveExtractor::Format>> EXTENSIONS = {{".tar.gz", ArchiveExtractor::Format::TAR_GZ},
+                                                                        {".tgz", ArchiveExtractor::Format::TAR_GZ},
+                                                                        {".tar.zst", ArchiveExtractor::Format::TAR_ZST},
+                                                                        {".tzst", ArchiveExtractor::Format::TAR_ZST},
+                                                                        {".tar", ArchiveExtractor::Format::TAR},
+                                                                        {".zip", ArchiveExtractor::Format::ZIP}};
+
+//----------------------------------------------------------------------------
+ArchiveExtractor::ArchiveExtractor(const QString &program, const QString &filename, const QString &folder, const Format format, QObject *parent)
+: QObject(parent)
+, m_program{program}
+, m_temporal{filename}
+, m_folder{folder}
+, m_format{format}
+, m_process{nullptr}
+, m_offset{0}
+, m_detached{false}
+, m_done{false}
+{
+  m_timer.setInterval(FEED_INTERVAL);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(feed()));
+}
+
+//----------------------------------------------------------------------------
+ArchiveExtractor::~ArchiveExtractor()
+{
+  stopProcess();
+}
+
+//----------------------------------------------------------------------------
+ArchiveExtractor::Format ArchiveExtractor::format(const QString &name)
+{
+  for(const auto &[extension, format]: EXTENSIONS)
+  {
+    if(name.endsWith(extension, Qt::CaseInsensitive)) return format;
+  }
+
+  return Format::NONE;
+}
+
+//----------------------------------------------------------------------------
+QString ArchiveExtractor::baseName(const QString &name)
+{
+  for(const auto &extension: EXTENSIONS)
+  {
+    if(name.endsWith(extension.first, Qt::CaseInsensitive)) return name.left(name.length() - extension.first.length());
+  }
+
+  return name;
+}
+
+//----------------------------------------------------------------------------
+bool ArchiveExtractor::isSupported(const QString &program, const Format format)
+{
+  if(format != Format::ZIP) return format != Format::NONE;
+
+  // gnu tar can't read zip archives, bsdtar tells its name in the version.
+  static QMutex mutex;
+  static QHash<QString, bool> results;
+
+  QMutexLocker lock(&mutex);
+  if(!results.contains(program))
+  {
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ProcessChannelMode::MergedChannels);
+    process.start(program, QStringList{"--version"});
+    const auto finished = process.waitForStarted() && process.waitForFinished(VERSION_TIMEOUT);
+    if(!finished) process.kill();
+
+    results.insert(program, finished && process.readAll().contains("bsdtar"));
+  }
+
+  return results.value(program);
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::start()
+{
+  if(m_process || m_done || m_format == Format::NONE) return;
+
+  if(!isSupported(m_program, m_format))
+  {
+    Metrics::add("extraction failures", 1);
+    end(false, QString("Zip archives need bsdtar, '%1' can't extract them.").arg(m_program));
+    return;
+  }
+
+  QDir().mkpath(m_folder);
+
+  // bsdtar detects the compression, gnu tar needs it for pipes.
+  QStringList arguments{"-x", "-f", "-", "-C", m_folder};
+  if(m_format == Format::TAR_GZ) arguments << "-z";
+  if(m_format == Format::TAR_ZST) arguments << "--zstd";
+
+  m_offset = 0;
+  m_errors.clear();
+  m_process = new QProcess(this);
+  connect(m_process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onFinished(int, QProcess::ExitStatus)));
+  connect(m_process, SIGNAL(readyReadStandardError()), this, SLOT(onErrorText()));
+  m_process->start(m_program, arguments);
+  if(!m_process->waitForStarted())
+  {
+    m_process->deleteLater();
+    m_process = nullptr;
+    end(false, QString("Unable to start the extractor '%1'.").arg(m_program));
+    return;
+  }
+
+  Tracer::instant("extraction start", reinterpret_cast<quintptr>(this), nullptr, 0, m_folder);
+  m_time.start();
+  m_timer.start();
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::restart()
+{
+  if(!m_process && !m_done) return;
+
+  stopProcess();
+  m_done = false;
+  Metrics::add("extraction restarts", 1);
+  start();
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::finish(const QString &filename)
+{
+  m_final = filename;
+  m_detached = true;
+  setParent(QCoreApplication::instance());
+
+  if(m_done)
+    deleteLater();
+  else
+    start();
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::abort()
+{
+  m_timer.stop();
+  stopProcess();
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::feed()
+{
+  if(!m_process) return;
+
+  // the file is renamed in this thread once complete, never while read.
+  const auto complete = !m_final.isEmpty();
+  QFile file((complete && !QFile::exists(m_temporal)) ? m_final : m_temporal);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    if(complete && !file.exists())
+    {
+      stopProcess();
+      Metrics::add("extraction failures", 1);
+      end(false, QString("Unable to extract to '%1', the file no longer exists.").arg(m_folder));
+    }
+    return;
+  }
+
+  const auto size = file.size();
+  if(size < m_offset)
+  {
+    file.close();
+    restart();
+    return;
+  }
+
+  if(!file.seek(m_offset)) return;
+  while(m_offset < size && m_process->bytesToWrite() < MAX_PENDING)
+  {
+    const auto data = file.read(std::min(READ_SIZE, size - m_offset));
+    if(data.isEmpty()) break;
+
+    m_process->write(data);
+    m_offset += data.size();
+  }
+
+  if(complete && m_offset >= size)
+  {
+    m_timer.stop();
+    m_process->closeWriteChannel();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::onFinished(int code, QProcess::ExitStatus status)
+{
+  m_timer.stop();
+  m_process->deleteLater();
+  m_process = nullptr;
+
+  const auto errors = QString::fromLocal8Bit(m_errors).trimmed();
+  if(code != 0 || status != QProcess::ExitStatus::NormalExit)
+  {
+    Metrics::add("extraction failures", 1);
+    end(false, QString("Extraction to '%1' failed with code %2%3").arg(m_folder).arg(code).arg(errors.isEmpty() ? QString(".") : ": " + errors));
+    return;
+  }
+
+  // an archive can end before the end of the file, the extraction is complete anyway.
+  m_done = true;
+  Metrics::add("archives extracted", 1);
+  Metrics::add("extraction msec", m_time.elapsed());
+  end(true, QString("Extracted to '%1'.").arg(m_folder));
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::onErrorText()
+{
+  m_errors.append(m_process->readAllStandardError());
+  if(m_errors.size() > MAX_ERROR_TEXT)
+    m_errors = m_errors.right(MAX_ERROR_TEXT);
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::stopProcess()
+{
+  if(!m_process) return;
+
+  m_timer.stop();
+  auto process = m_process;
+  m_process = nullptr;
+  process->disconnect(this);
+  process->kill();
+  process->waitForFinished();
+  process->deleteLater();
+}
+
+//----------------------------------------------------------------------------
+void ArchiveExtractor::end(const bool success, const QString &message)
+{
+  Tracer::instant(success ? "extraction end" : "extraction failure", reinterpret_cast<quintptr>(this), nullptr, 0, message);
+  emit finished(success, message);
+
+  if(m_detached) deleteLater();
+}
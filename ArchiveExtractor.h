@@ -0,0 +1,166 @@
+/*
+ File: ArchiveExtractor.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ARCHIVE_EXTRACTOR_H_
+#define _ARCHIVE_EXTRACTOR_H_
+
+// Qt
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/**
+ * @brief Extracts an archive while it's downloaded. The temporal file is read from the first byte
+ * as it grows and piped to an external tar executable (bsdtar is needed for zip files) that writes
+ * into the target folder. If the file is truncated, because the download restarts from the
+ * beginning, the extraction starts again replaying the file, so it's always correct after resumes
+ * and restarts of the application.
+ */
+class ArchiveExtractor
+: public QObject
+{
+    Q_OBJECT
+  public:
+    enum class Format: char { NONE = 0, TAR = 1, TAR_GZ = 2, TAR_ZST = 3, ZIP = 4 };
+
+    /**
+     * @brief ArchiveExtractor class constructor.
+     * @param program Path of the tar executable.
+     * @param filename Temporal file of the download.
+     * @param folder Folder where the archive is extracted.
+     * @param format Format of the archive.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    explicit ArchiveExtractor(const QString &program, const QString &filename, const QString &folder, const Format format, QObject *parent = nullptr);
+
+    /**
+     * @brief ArchiveExtractor class virtual destructor.
+     */
+    virtual ~ArchiveExtractor();
+
+    /**
+     * @brief Returns the format of the archive from its file name.
+     * @param name File name.
+     */
+    static Format format(const QString &name);
+
+    /**
+     * @brief Returns the name of the archive without its extension, the name of the target folder.
+     * @param name File name.
+     */
+    static QString baseName(const QString &name);
+
+    /**
+     * @brief Returns true if the tar executable can extract the format from a pipe. Zip archives
+     * need bsdtar, the result of checking the version of the executable is kept.
+     * @param program Path of the tar executable.
+     * @param format Format of the archive.
+     */
+    static bool isSupported(const QString &program, const Format format);
+
+    /**
+     * @brief Returns the temporal file read.
+     */
+    const QString &filename() const
+    { return m_temporal; }
+
+    /**
+     * @brief Returns the bytes of the archive given to the extractor.
+     */
+    qint64 extractedBytes() const
+    { return m_offset; }
+
+    /**
+     * @brief Starts the extraction if not running or already extracted.
+     */
+    void start();
+
+    /**
+     * @brief Starts the extraction again from the first byte of the file.
+     */
+    void restart();
+
+    /**
+     * @brief The download is complete, the rest of the file is read from the given file once the
+     * temporal file has been renamed and the extraction ends at the end of the file. The extractor is
+     * owned by the application from now on and is deleted when the extraction ends.
+     * @param filename Final name of the downloaded file.
+     */
+    void finish(const QString &filename);
+
+    /**
+     * @brief Stops the extraction, the files already extracted are kept.
+     */
+    void abort();
+
+  signals:
+    /**
+     * @brief Emitted when the extraction of the complete archive ends or fails.
+     * @param success True if the archive has been extracted.
+     * @param message Result text.
+     */
+    void finished(bool success, const QString &message);
+
+  private slots:
+    /**
+     * @brief Gives the extractor the new data of the file.
+     */
+    void feed();
+
+    /**
+     * @brief Handles the end of the extractor process.
+     * @param code Exit code.
+     * @param status Exit status.
+     */
+    void onFinished(int code, QProcess::ExitStatus status);
+
+    /**
+     * @brief Keeps the last error messages of the extractor process.
+     */
+    void onErrorText();
+
+  private:
+    /**
+     * @brief Kills the extractor process, if any.
+     */
+    void stopProcess();
+
+    /**
+     * @brief Emits the result and schedules the deletion if owned by the application.
+     * @param success True if extracted.
+     * @param message Result text.
+     */
+    void end(const bool success, const QString &message);
+
+    const QString m_program;  /** tar executable. */
+    const QString m_temporal; /** temporal file of the download. */
+    QString m_final;          /** final file name once the download is complete, empty before. */
+    const QString m_folder;   /** target folder. */
+    const Format m_format;    /** format of the archive. */
+    QProcess *m_process;      /** extractor process or nullptr. */
+    QTimer m_timer;           /** feed timer. */
+    QElapsedTimer m_time;     /** time since the start of the extraction. */
+    qint64 m_offset;          /** bytes of the file given to the extractor. */
+    QByteArray m_errors;      /** last error text of the extractor. */
+    bool m_detached;          /** true once owned by the application. */
+    bool m_done;              /** true if the archive has been extracted. */
+};
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ File: BackgroundRate.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <BackgroundRate.h>
+#include <Metrics.h>
+
+// Qt
+#include <QTcpSocket>
+
+// C++
+#include <algorithm>
+
+const int PROBE_INTERVAL_MS = 2000;
+const qint64 PROBE_TIMEOUT_MS = 5000;
+const qint64 TARGET_DELAY_MS = 100;     // queuing delay accepted, as in LEDBAT.
+const size_t CURRENT_FILTER = 3;        // samples of the current delay, the lowest is used.
+const qint64 BASE_HISTORY_MINUTES = 10; // minutes of the base delay history.
+const double GAIN = 0.1;                // fraction of the rate added per probe at zero queuing delay.
+const double MIN_RATE = 16 * 1024;
+const double INITIAL_RATE = 256 * 1024;
+const double MAX_RATE = 1024.0 * 1024 * 1024;
+
+//----------------------------------------------------------------------------
+BackgroundRate::BackgroundRate(QObject *parent)
+: QObject(parent)
+, m_port{0}
+, m_socket{nullptr}
+, m_rate{INITIAL_RATE}
+, m_throughput{0}
+, m_queuingDelay{0}
+{
+  m_timer.setInterval(PROBE_INTERVAL_MS);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(probe()));
+}
+
+//----------------------------------------------------------------------------
+BackgroundRate::~BackgroundRate()
+{
+  abortProbe();
+}
+
+//----------------------------------------------------------------------------
+void BackgroundRate::start(const QString &host, const quint16 port)
+{
+  if(host != m_host || port != m_port)
+  {
+    abortProbe();
+    m_host = host;
+    m_port = port;
+    m_current.clear();
+    m_baseHistory.clear();
+    m_clock.start();
+  }
+
+  if(m_timer.isActive()) return;
+
+  m_timer.start();
+  probe();
+}
+
+//----------------------------------------------------------------------------
+void BackgroundRate::stop()
+{
+  m_timer.stop();
+  abortProbe();
+}
+
+//----------------------------------------------------------------------------
+void BackgroundRate::probe()
+{
+  if(m_socket)
+  {
+    if(m_probeTime.elapsed() < PROBE_TIMEOUT_MS) return;
+
+    // a lost probe of a host that answered before is a sign of congestion.
+    abortProbe();
+    if(!m_baseHistory.empty()) addSample(PROBE_TIMEOUT_MS);
+    return;
+  }
+
+  auto socket = new QTcpSocket(this);
+  m_socket = socket;
+
+  connect(socket, &QTcpSocket::connected, this, [this, socket]()
+  {
+    if(socket != m_socket) return;
+
+    const auto delay = m_probeTime.elapsed();
+    abortProbe();
+    addSample(delay);
+  });
+
+  connect(socket, &QTcpSocket::errorOccurred, this, [this, socket]()
+  {
+    if(socket == m_socket) abortProbe();
+  });
+
+  m_probeTime.start();
+  socket->connectToHost(m_host, m_port);
+}
+
+//----------------------------------------------------------------------------
+void BackgroundRate::abortProbe()
+{
+  if(!m_socket) return;
+
+  auto socket = m_socket;
+  m_socket = nullptr;
+  socket->disconnect(this);
+  socket->abort();
+  socket->deleteLater();
+}
+
+//----------------------------------------------------------------------------
+void BackgroundRate::addSample(const qint64 delay)
+{
+  m_current.push_back(delay);
+  while(m_current.size() > CURRENT_FILTER)
+    m_current.pop_front();
+
+  // base delay is the lowest of the last minutes, to follow route changes.
+  const auto minute = m_clock.elapsed() / 60000;
+  if(m_baseHistory.empty() || m_baseHistory.back().first != minute)
+    m_baseHistory.emplace_back(minute, delay);
+  else
+    m_baseHistory.back().second = std::min(m_baseHistory.back().second, delay);
+  while(minute - m_baseHistory.front().first >= BASE_HISTORY_MINUTES)
+    m_baseHistory.pop_front();
+
+  const auto current = *std::min_element(m_current.cbegin(), m_current.cend());
+  const auto base = std::min_element(m_baseHistory.cbegin(), m_baseHistory.cend(), [](const auto &a, const auto &b) { return a.second < b.second; })->second;
+  m_queuingDelay = current - base;
+
+  const auto previous = rate();
+  const auto offTarget = static_cast<double>(TARGET_DELAY_MS - m_queuingDelay) / TARGET_DELAY_MS;
+  if(offTarget >= 0)
+  {
+    // the rate only grows while the transfer reaches it, otherwise the limit isn't the bottleneck.
+    if(m_throughput > 0 && m_rate < 2.0 * m_throughput)
+      m_rate += offTarget * (GAIN * m_rate + MIN_RATE);
+  }
+  else
+  {
+    m_rate *= std::max(0.5, 1.0 + offTarget / 2);
+  }
+  m_rate = std::clamp(m_rate, MIN_RATE, MAX_RATE);
+
+  if(rate() != previous)
+  {
+    if(rate() < previous) Metrics::add("background rate decreases", 1);
+    emit rateChanged(rate());
+  }
+}
@@ -0,0 +1,127 @@
+/*
+ File: BackgroundRate.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BACKGROUND_RATE_H_
+#define _BACKGROUND_RATE_H_
+
+// Qt
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QString>
+
+// C++
+#include <deque>
+#include <utility>
+
+class QTcpSocket;
+
+/**
+ * @brief Rate controller of the background transfers, in the spirit of LEDBAT (RFC 6817). The
+ * round trip time to the host or proxy is probed with TCP connections, the lowest delay of the
+ * last minutes is the base delay and the rest is the queuing delay caused by the traffic of the
+ * link. The rate grows while the queuing delay is below the target and falls in proportion when
+ * it is over it, so the transfer only uses the capacity other traffic leaves idle.
+ */
+class BackgroundRate
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /**
+     * @brief BackgroundRate class constructor.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    explicit BackgroundRate(QObject *parent = nullptr);
+
+    /**
+     * @brief BackgroundRate class virtual destructor.
+     */
+    virtual ~BackgroundRate();
+
+    /**
+     * @brief Starts probing the given host. The delay history is kept if the host doesn't change.
+     * @param host Host name or address.
+     * @param port TCP port.
+     */
+    void start(const QString &host, const quint16 port);
+
+    /**
+     * @brief Stops probing.
+     */
+    void stop();
+
+    /**
+     * @brief Returns the rate limit in bytes per second.
+     */
+    qint64 rate() const
+    { return static_cast<qint64>(m_rate); }
+
+    /**
+     * @brief Returns the last queuing delay measured in milliseconds.
+     */
+    qint64 queuingDelay() const
+    { return m_queuingDelay; }
+
+    /**
+     * @brief Sets the current speed of the transfer, the rate doesn't grow while it isn't reached.
+     * @param speed Speed in bytes per second.
+     */
+    void setThroughput(const qint64 speed)
+    { m_throughput = speed; }
+
+  signals:
+    /**
+     * @brief Emitted when the rate limit changes.
+     * @param rate Rate limit in bytes per second.
+     */
+    void rateChanged(qint64 rate);
+
+  private slots:
+    /**
+     * @brief Measures the time to connect to the host.
+     */
+    void probe();
+
+  private:
+    /**
+     * @brief Updates the delays and the rate with a new delay sample.
+     * @param delay Connection time in milliseconds.
+     */
+    void addSample(const qint64 delay);
+
+    /**
+     * @brief Aborts the probe in progress, if any.
+     */
+    void abortProbe();
+
+    QString m_host;                /** probed host. */
+    quint16 m_port;                /** probed port. */
+    QTimer m_timer;                /** probe timer. */
+    QTcpSocket *m_socket;          /** probe in progress or nullptr. */
+    QElapsedTimer m_probeTime;     /** time since the start of the probe. */
+    QElapsedTimer m_clock;         /** time since the start of the history. */
+    std::deque<qint64> m_current;  /** last delay samples. */
+    std::deque<std::pair<qint64, qint64>> m_baseHistory; /** (minute, minimum delay) of the last minutes. */
+    double m_rate;                 /** rate limit in bytes per second. */
+    qint64 m_throughput;           /** current speed of the transfer in bytes per second. */
+    qint64 m_queuingDelay;         /** last queuing delay in milliseconds. */
+};
+
+#endif
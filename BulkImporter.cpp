@@ -0,0 +1,220 @@
+/*
+ File: BulkImporter.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <BulkImporter.h>
+#include <ProxyPool.h>
+#include <Checksums.h>
+
+// Qt
+#include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QTimer>
+#include <QRegularExpression>
+
+const int LINES_PER_CHUNK = 2000;
+const QRegularExpression WHITESPACE("\\s+");
+const QRegularExpression HASH_SEPARATOR("[:=]");
+
+namespace
+{
+  /**
+   * @brief Splits a CSV line, fields can be quoted with double quotes.
+   * @param line Line text.
+   * @param separator Field separator.
+   */
+  QStringList splitCsv(const QString &line, const QChar separator)
+  {
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+
+    for(int i = 0; i < line.size(); ++i)
+    {
+      const auto c = line.at(i);
+      if(c == '"')
+      {
+        // "" is a quote inside a quoted field.
+        if(quoted && i + 1 < line.size() && line.at(i + 1) == '"')
+        {
+          field += c;
+          ++i;
+        }
+        else
+          quoted = !quoted;
+      }
+      else if(c == separator && !quoted)
+      {
+        fields << field.trimmed();
+        field.clear();
+      }
+      else
+        field += c;
+    }
+    fields << field.trimmed();
+
+    return fields;
+  }
+}
+
+//----------------------------------------------------------------------------
+BulkImporter::BulkImporter(QObject *parent)
+: QObject(parent)
+, m_separator{' '}
+, m_lines{0}
+, m_items{0}
+{
+}
+
+//----------------------------------------------------------------------------
+bool BulkImporter::start(const QString &filename)
+{
+  if(isRunning()) return false;
+
+  auto file = std::make_unique<QFile>(filename);
+  if(!file->open(QIODevice::ReadOnly|QIODevice::Text))
+    return false;
+
+  const auto separator = QFileInfo(filename).suffix().compare("csv", Qt::CaseInsensitive) == 0 ? QChar(',') : QChar(' ');
+  start(std::move(file), separator);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool BulkImporter::start(const QByteArray &text)
+{
+  if(isRunning()) return false;
+
+  auto buffer = std::make_unique<QBuffer>();
+  buffer->setData(text);
+  buffer->open(QIODevice::ReadOnly|QIODevice::Text);
+
+  start(std::move(buffer), QChar(' '));
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void BulkImporter::start(std::unique_ptr<QIODevice> device, const QChar separator)
+{
+  m_device = std::move(device);
+  m_separator = separator;
+  m_lines = 0;
+  m_items = 0;
+
+  QTimer::singleShot(0, this, SLOT(readChunk()));
+}
+
+//----------------------------------------------------------------------------
+void BulkImporter::abort()
+{
+  if(!isRunning()) return;
+
+  m_device.reset();
+  emit finished(m_lines, m_items);
+}
+
+//----------------------------------------------------------------------------
+void BulkImporter::readChunk()
+{
+  if(!isRunning()) return;
+
+  std::vector<Utils::ItemInformation> items;
+  items.reserve(LINES_PER_CHUNK);
+
+  for(int i = 0; i < LINES_PER_CHUNK && !m_device->atEnd(); ++i)
+  {
+    const auto line = QString::fromUtf8(m_device->readLine());
+    ++m_lines;
+
+    Utils::ItemInformation item;
+    if(parseLine(line, m_separator, item))
+      items.push_back(item);
+  }
+
+  m_items += items.size();
+  if(!items.empty())
+    emit itemsRead(items);
+
+  // the receiver may have aborted the import.
+  if(!isRunning()) return;
+
+  if(m_device->atEnd())
+  {
+    m_device.reset();
+    emit finished(m_lines, m_items);
+    return;
+  }
+
+  // let the event loop run between chunks.
+  QTimer::singleShot(0, this, SLOT(readChunk()));
+}
+
+//----------------------------------------------------------------------------
+bool BulkImporter::parseLine(const QString &line, const QChar separator, Utils::ItemInformation &item)
+{
+  const auto text = line.trimmed();
+  if(text.isEmpty() || text.startsWith('#')) return false;
+
+  const auto fields = (separator == ' ') ? text.split(WHITESPACE, Qt::SkipEmptyParts) : splitCsv(text, separator);
+
+  const QUrl url(fields.at(0), QUrl::StrictMode);
+  const auto scheme = url.scheme().toLower();
+  if(!url.isValid() || url.host().isEmpty() || !(scheme == "http" || scheme == "https" || scheme == "ftp" || scheme == "ftps"))
+    return false;
+
+  item = Utils::ItemInformation(url, QString(), 0, Utils::Protocol::NONE, QString());
+
+  if(fields.size() > 1)
+    item.outputName = QFileInfo(fields.at(1)).fileName();
+  if(item.outputName.isEmpty())
+    item.outputName = url.fileName();
+  if(item.outputName.isEmpty())
+    item.outputName = url.host();
+
+  if(fields.size() > 2 && !fields.at(2).isEmpty())
+  {
+    ProxyPool::Proxy proxy;
+    if(fields.at(2).compare("pool", Qt::CaseInsensitive) == 0)
+      item.usePool = true;
+    else if(ProxyPool::parse(fields.at(2), proxy))
+    {
+      item.server = proxy.server;
+      item.port = proxy.port;
+      item.protocol = proxy.protocol;
+    }
+    else
+      return false;
+  }
+
+  // 'type:hex' or 'type=hex'.
+  if(fields.size() > 3 && !fields.at(3).isEmpty())
+  {
+    const auto separatorIndex = fields.at(3).indexOf(HASH_SEPARATOR);
+    const auto type = fields.at(3).left(separatorIndex);
+    const auto hash = QByteArray::fromHex(fields.at(3).mid(separatorIndex + 1).toLatin1());
+    if(separatorIndex <= 0 || hash.isEmpty() || Checksums::strength(type) == -1)
+      return false;
+
+    item.hashes.type = type;
+    item.hashes.hash = hash;
+  }
+
+  return true;
+}
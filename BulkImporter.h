@@ -0,0 +1,123 @@
+/*
+ File: BulkImporter.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BULK_IMPORTER_H_
+#define _BULK_IMPORTER_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QObject>
+#include <QIODevice>
+
+// C++
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Reads lists of urls from a file or text in chunks from the event loop, so lists of any
+ * size can be imported without freezing the UI. Each line has the url and, optionally, the output
+ * name, the proxy ('socks5://server:port' or 'pool') and the checksum ('sha-256:<hex>'), separated
+ * by spaces or tabs, or by commas in CSV files.
+ */
+class BulkImporter
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /**
+     * @brief BulkImporter class constructor.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    explicit BulkImporter(QObject *parent = nullptr);
+
+    /**
+     * @brief BulkImporter class virtual destructor.
+     */
+    virtual ~BulkImporter()
+    {};
+
+    /**
+     * @brief Starts reading the given file. Returns false if it can't be opened or there is an
+     * import running.
+     * @param filename List file, CSV if the extension is .csv.
+     */
+    bool start(const QString &filename);
+
+    /**
+     * @brief Starts reading the given text. Returns false if there is an import running.
+     * @param text List text.
+     */
+    bool start(const QByteArray &text);
+
+    /**
+     * @brief Stops reading, the items already read are not affected.
+     */
+    void abort();
+
+    /**
+     * @brief Returns true if there is an import running.
+     */
+    bool isRunning() const
+    { return m_device != nullptr; }
+
+    /**
+     * @brief Parses a line of a list. Returns false if the line is empty, a comment or invalid.
+     * @param line Line text.
+     * @param separator Field separator, ',' for CSV (with quoted fields), a space for any whitespace.
+     * @param item Item information.
+     */
+    static bool parseLine(const QString &line, const QChar separator, Utils::ItemInformation &item);
+
+  signals:
+    /**
+     * @brief Emitted with the items of every chunk of lines read.
+     * @param items Items read.
+     */
+    void itemsRead(const std::vector<Utils::ItemInformation> &items);
+
+    /**
+     * @brief Emitted when the list has been read completely or aborted.
+     * @param lines Number of lines read.
+     * @param items Number of valid items.
+     */
+    void finished(qint64 lines, qint64 items);
+
+  private slots:
+    /**
+     * @brief Reads and parses the next chunk of lines and schedules the next one.
+     */
+    void readChunk();
+
+  private:
+    /**
+     * @brief Starts reading from the device.
+     * @param device Opened device.
+     * @param separator Field separator.
+     */
+    void start(std::unique_ptr<QIODevice> device, const QChar separator);
+
+    std::unique_ptr<QIODevice> m_device; /** list being read or nullptr. */
+    QChar m_separator;                   /** field separator of the list. */
+    qint64 m_lines;                      /** lines read. */
+    qint64 m_items;                      /** valid items read. */
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ File: Checksums.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Checksums.h>
+
+// Qt
+#include <QFile>
+
+// C++
+#include <algorithm>
+#include <memory>
+
+const qint64 READ_SIZE = 1024 * 1024;
+
+namespace
+{
+  /** supported hashes from weakest to strongest. */
+  const std::vector<std::pair<QString, QCryptographicHash::Algorithm>> ALGORITHMS = {
+    {"md5",      QCryptographicHash::Md5},
+    {"sha1",     QCryptographicHash::Sha1},
+    {"sha224",   QCryptographicHash::Sha224},
+    {"sha256",   QCryptographicHash::Sha256},
+    {"sha384",   QCryptographicHash::Sha384},
+    {"sha512",   QCryptographicHash::Sha512},
+    {"sha3224",  QCryptographicHash::Sha3_224},
+    {"sha3256",  QCryptographicHash::Sha3_256},
+    {"sha3384",  QCryptographicHash::Sha3_384},
+    {"sha3512",  QCryptographicHash::Sha3_512}
+  };
+
+  /**
+   * @brief Returns the index of the algorithm in the list or -1.
+   * @param name Hash name.
+   */
+  int algorithmIndex(const QString &name)
+  {
+    const auto key = name.toLower().remove('-').remove('_');
+    auto it = std::find_if(ALGORITHMS.cbegin(), ALGORITHMS.cend(), [&key](const auto &a) { return a.first == key; });
+    return it == ALGORITHMS.cend() ? -1 : static_cast<int>(std::distance(ALGORITHMS.cbegin(), it));
+  }
+}
+
+//----------------------------------------------------------------------------
+int Checksums::Result::badPieces() const
+{
+  return std::count(pieces.cbegin(), pieces.cend(), false);
+}
+
+//----------------------------------------------------------------------------
+bool Checksums::algorithm(const QString &name, QCryptographicHash::Algorithm &algorithm)
+{
+  const auto index = algorithmIndex(name);
+  if(index == -1) return false;
+
+  algorithm = ALGORITHMS.at(index).second;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int Checksums::strength(const QString &name)
+{
+  return algorithmIndex(name);
+}
+
+//----------------------------------------------------------------------------
+Checksums::Result Checksums::verify(const QString &filename, const Utils::FileHashes &hashes, const bool wholeFile)
+{
+  Result result;
+
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    return result;
+
+  result.valid = true;
+
+  QCryptographicHash::Algorithm fileAlgorithm, pieceAlgorithm;
+  std::unique_ptr<QCryptographicHash> fileHash, pieceHash;
+  if(wholeFile && !hashes.hash.isEmpty() && algorithm(hashes.type, fileAlgorithm))
+    fileHash = std::make_unique<QCryptographicHash>(fileAlgorithm);
+  if(!hashes.pieces.isEmpty() && hashes.pieceLength > 0 && algorithm(hashes.pieceType, pieceAlgorithm))
+    pieceHash = std::make_unique<QCryptographicHash>(pieceAlgorithm);
+
+  if(!fileHash && !pieceHash)
+    return result;
+
+  // pieces not read are missing.
+  if(pieceHash)
+    result.pieces.assign(hashes.pieces.size(), false);
+
+  qint64 piece = 0;
+  qint64 pieceBytes = 0;
+  auto endPiece = [&]()
+  {
+    if(piece < static_cast<qint64>(result.pieces.size()))
+      result.pieces[piece] = (pieceHash->result() == hashes.pieces.at(piece));
+    pieceHash->reset();
+    pieceBytes = 0;
+    ++piece;
+  };
+
+  QByteArray buffer;
+  while(!file.atEnd())
+  {
+    buffer = file.read(READ_SIZE);
+    if(buffer.isEmpty()) break;
+
+    if(fileHash) fileHash->addData(buffer);
+    if(!pieceHash) continue;
+
+    // pieces don't need to be aligned with the reads.
+    qint64 offset = 0;
+    while(offset < buffer.size())
+    {
+      const auto count = std::min(static_cast<qint64>(buffer.size()) - offset, hashes.pieceLength - pieceBytes);
+      pieceHash->addData(QByteArrayView(buffer.constData() + offset, count));
+      pieceBytes += count;
+      offset += count;
+
+      if(pieceBytes == hashes.pieceLength) endPiece();
+    }
+  }
+
+  // the last piece can be shorter.
+  if(pieceHash && pieceBytes > 0) endPiece();
+
+  if(fileHash)
+    result.fileMatches = (fileHash->result() == hashes.hash);
+
+  return result;
+}
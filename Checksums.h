@@ -0,0 +1,76 @@
+/*
+ File: Checksums.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CHECKSUMS_H_
+#define _CHECKSUMS_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QCryptographicHash>
+
+// C++
+#include <vector>
+
+/**
+ * @brief Verification of the downloaded files with the hashes of the manifests.
+ */
+namespace Checksums
+{
+  /**
+   * @brief Result of the verification of a file.
+   */
+  struct Result
+  {
+    bool valid = false;       /** true if the file could be read. */
+    bool fileMatches = true;  /** true if the whole file hash matches or wasn't checked. */
+    std::vector<bool> pieces; /** true for each piece whose hash matches. */
+
+    /**
+     * @brief Returns the number of pieces whose hash doesn't match.
+     */
+    int badPieces() const;
+  };
+
+  /**
+   * @brief Returns the algorithm of the given hash name (RFC 5854 'sha-256' or metalink 3 'sha256'
+   * names). Returns false if not supported.
+   * @param name Hash name.
+   * @param algorithm Algorithm.
+   */
+  bool algorithm(const QString &name, QCryptographicHash::Algorithm &algorithm);
+
+  /**
+   * @brief Returns the strength of the given hash, higher is better, -1 if not supported.
+   * @param name Hash name.
+   */
+  int strength(const QString &name);
+
+  /**
+   * @brief Reads the file once and verifies its pieces and, optionally, the whole file hash.
+   * Can be called from any thread.
+   * @param filename File to verify.
+   * @param hashes Hashes of the file.
+   * @param wholeFile True to check the whole file hash.
+   */
+  Result verify(const QString &filename, const Utils::FileHashes &hashes, const bool wholeFile);
+}
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ File: ConcurrencyTuner.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ConcurrencyTuner.h>
+#include <Metrics.h>
+
+// C++
+#include <algorithm>
+
+const unsigned int PERIOD_SAMPLES = 10;      // samples averaged in each period.
+const unsigned int SETTLE_SAMPLES = 3;       // samples ignored after a change while the transfers ramp up.
+const unsigned int HOLD_PERIODS = 6;         // periods without probing after finding the best value.
+const unsigned int DEFAULT_CONNECTIONS = 8;  // initial connections without a limit of active downloads.
+const unsigned int MAXIMUM_CONNECTIONS = 128; // maximum connections without a limit of active downloads.
+const double GAIN = 0.05;                    // relative throughput increase considered an improvement.
+const double LOSS = 0.10;                    // relative throughput decrease considered a loss.
+
+//----------------------------------------------------------------------------
+ConcurrencyTuner::ConcurrencyTuner(const Utils::Configuration &config)
+: m_config{config}
+{
+  reset();
+}
+
+//----------------------------------------------------------------------------
+void ConcurrencyTuner::reset()
+{
+  const auto initial = m_config.maxActiveDownloads > 0 ? m_config.maxActiveDownloads : DEFAULT_CONNECTIONS;
+
+  m_connections = std::min(initial, maximum());
+  m_previous = m_connections;
+  m_sum = 0;
+  m_samples = 0;
+  m_saturated = 0;
+  m_settle = 0;
+  m_lastThroughput = 0;
+  m_lastAction = Action::NONE;
+  m_hold = 0;
+
+  Metrics::set("tuned connections", m_connections);
+}
+
+//----------------------------------------------------------------------------
+unsigned int ConcurrencyTuner::maximum() const
+{
+  if(m_config.maxActiveDownloads == 0) return MAXIMUM_CONNECTIONS;
+
+  return m_config.maxActiveDownloads * std::max(1u, m_config.maxSegments);
+}
+
+//----------------------------------------------------------------------------
+bool ConcurrencyTuner::addSample(const qint64 throughput, const bool saturated)
+{
+  if(m_settle > 0)
+  {
+    --m_settle;
+    return false;
+  }
+
+  m_sum += throughput;
+  ++m_samples;
+  if(saturated) ++m_saturated;
+
+  if(m_samples < PERIOD_SAMPLES) return false;
+
+  const auto average = static_cast<double>(m_sum) / m_samples;
+  const auto wasSaturated = m_saturated * 2 > m_samples;
+  m_sum = 0;
+  m_samples = 0;
+  m_saturated = 0;
+
+  Metrics::set("tuned throughput", static_cast<qint64>(average));
+
+  // the connections weren't all used, the period says nothing about them.
+  if(!wasSaturated || average <= 0)
+  {
+    m_lastThroughput = 0;
+    m_lastAction = Action::NONE;
+    return false;
+  }
+
+  const auto before = m_connections;
+  const auto last = m_lastThroughput;
+  m_lastThroughput = average;
+
+  const auto increased = m_connections + std::max(1u, m_connections / 8);
+  const auto decreased = std::min(m_connections - 1, m_connections * 3 / 4);
+
+  if(last <= 0)
+  {
+    apply(increased, Action::INCREASE);
+    return m_connections != before;
+  }
+
+  const auto change = (average - last) / last;
+  switch(m_lastAction)
+  {
+    case Action::INCREASE:
+      if(change > GAIN)
+      {
+        apply(increased, Action::INCREASE);
+      }
+      else if(change < -LOSS)
+      {
+        apply(decreased, Action::DECREASE);
+      }
+      else
+      {
+        // the last connections added didn't help, undo and stay there for a while.
+        m_lastThroughput = last;
+        Metrics::add("tuning reverts", 1);
+        apply(m_previous, Action::HOLD);
+      }
+      break;
+    case Action::DECREASE:
+      if(change < -LOSS)
+      {
+        m_lastThroughput = last;
+        Metrics::add("tuning reverts", 1);
+        apply(m_previous, Action::HOLD);
+      }
+      else
+      {
+        apply(m_connections, Action::HOLD);
+      }
+      break;
+    default:
+      if(change < -LOSS)
+      {
+        apply(decreased, Action::DECREASE);
+      }
+      else if(m_hold > 0)
+      {
+        --m_hold;
+      }
+      else
+      {
+        apply(increased, Action::INCREASE);
+      }
+      break;
+  }
+
+  return m_connections != before;
+}
+
+//----------------------------------------------------------------------------
+void ConcurrencyTuner::apply(const unsigned int connections, const Action action)
+{
+  const auto value = std::clamp(connections, 1u, maximum());
+
+  // at the limits there is nothing to probe, wait like after finding the best value.
+  if(value == m_connections || action == Action::HOLD)
+  {
+    if(value != m_connections) m_settle = SETTLE_SAMPLES;
+    m_connections = value;
+    m_lastAction = Action::HOLD;
+    m_hold = HOLD_PERIODS;
+    Metrics::set("tuned connections", m_connections);
+    return;
+  }
+
+  Metrics::add(value > m_connections ? "tuning increases" : "tuning decreases", 1);
+
+  m_previous = m_connections;
+  m_connections = value;
+  m_lastAction = action;
+  m_settle = SETTLE_SAMPLES;
+  Metrics::set("tuned connections", m_connections);
+}
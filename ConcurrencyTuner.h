@@ -0,0 +1,88 @@
+/*
+ File: ConcurrencyTuner.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CONCURRENCY_TUNER_H_
+#define _CONCURRENCY_TUNER_H_
+
+// Project
+#include <Utils.h>
+
+/**
+ * @brief Hill climbing controller of the number of connections used by the downloads. Every period
+ * the aggregate throughput is compared with the previous one: connections are added while the
+ * throughput grows, the last step is undone if it doesn't help and the connections are reduced
+ * multiplicatively if the throughput falls. Only the periods where the downloads can use all the
+ * connections are measured. The decisions are recorded in the metrics.
+ */
+class ConcurrencyTuner
+{
+  public:
+    /**
+     * @brief ConcurrencyTuner class constructor.
+     * @param config Application configuration reference.
+     */
+    explicit ConcurrencyTuner(const Utils::Configuration &config);
+
+    /**
+     * @brief Starts tuning again from the configured number of active downloads.
+     */
+    void reset();
+
+    /**
+     * @brief Adds a throughput sample, taken every second. Returns true if the number of connections
+     * has changed.
+     * @param throughput Aggregate speed of the downloads in bytes per second.
+     * @param saturated True if the downloads are using all the connections.
+     */
+    bool addSample(const qint64 throughput, const bool saturated);
+
+    /**
+     * @brief Returns the number of connections to use.
+     */
+    unsigned int connections() const
+    { return m_connections; }
+
+    /**
+     * @brief Returns the maximum number of connections the tuner can use.
+     */
+    unsigned int maximum() const;
+
+  private:
+    enum class Action: char { NONE = 0, INCREASE = 1, DECREASE = 2, HOLD = 3 };
+
+    /**
+     * @brief Changes the number of connections and records the decision.
+     * @param connections New number of connections.
+     * @param action Action taken.
+     */
+    void apply(const unsigned int connections, const Action action);
+
+    const Utils::Configuration &m_config; /** application configuration reference. */
+    unsigned int m_connections;           /** connections to use. */
+    unsigned int m_previous;              /** connections before the last change. */
+    qint64 m_sum;                         /** sum of the samples of the current period. */
+    unsigned int m_samples;               /** samples of the current period. */
+    unsigned int m_saturated;             /** saturated samples of the current period. */
+    unsigned int m_settle;                /** samples to ignore after a change. */
+    double m_lastThroughput;              /** average throughput of the last measured period, 0 if none. */
+    Action m_lastAction;                  /** action taken after the last measured period. */
+    unsigned int m_hold;                  /** periods to wait before probing again. */
+};
+
+#endif
@@ -19,6 +19,8 @@
 
 // Project
 #include <ConfigurationDialog.h>
+#include <ProxyPool.h>
+#include <Schedule.h>
 
 // Qt
 #include <QFileDialog>
@@ -37,16 +39,31 @@ ConfigurationDialog::ConfigurationDialog(QWidget *parent, Qt::WindowFlags f)
 //----------------------------------------------------------------------------
 Utils::Configuration ConfigurationDialog::getConfiguration() const
 {
-  return Utils::Configuration(m_curlLocation->text(), m_DownloadFolder->text(), m_waitSpinbox->value(), m_extension->text());
+  auto config = m_config;
+  config.curlPath = m_curlLocation->text();
+  config.downloadPath = m_DownloadFolder->text();
+  config.waitSeconds = m_waitSpinbox->value();
+  config.extension = m_extension->text();
+  config.proxyPool = m_proxyPool->toPlainText().split('\n', Qt::SkipEmptyParts);
+  for(auto &proxy: config.proxyPool) proxy = proxy.trimmed();
+  config.proxyPool.removeAll(QString());
+  config.schedule = m_schedule->toPlainText().split('\n', Qt::SkipEmptyParts);
+  for(auto &rule: config.schedule) rule = rule.simplified();
+  config.schedule.removeAll(QString());
+
+  return config;
 }
 
 //----------------------------------------------------------------------------
 void ConfigurationDialog::setConfiguration(const Utils::Configuration &config)
 {
+  m_config = config;
   if(!Utils::curlExecutableVersion(config.curlPath).isEmpty()) m_curlLocation->setText(config.curlPath);
   if(QDir(config.downloadPath).exists()) m_DownloadFolder->setText(config.downloadPath);
   if(config.waitSeconds >= 5) m_waitSpinbox->setValue(config.waitSeconds);
   m_extension->setText(config.extension);
+  m_proxyPool->setPlainText(config.proxyPool.join('\n'));
+  m_schedule->setPlainText(config.schedule.join('\n'));
 }
 
 //----------------------------------------------------------------------------
@@ -103,7 +120,7 @@ void ConfigurationDialog::onDownloadFolderClicked()
 //----------------------------------------------------------------------------
 void ConfigurationDialog::closeEvent(QCloseEvent *e)
 {
-  const Utils::Configuration config(m_curlLocation->text(), m_DownloadFolder->text(), m_waitSpinbox->value(), m_extension->text());
+  const auto config = getConfiguration();
 
   if(!config.isValid())
   {
@@ -123,6 +140,42 @@ void ConfigurationDialog::closeEvent(QCloseEvent *e)
     return;
   }
 
+  for(const auto &text: config.proxyPool)
+  {
+    ProxyPool::Proxy proxy;
+    if(!ProxyPool::parse(text, proxy))
+    {
+      e->setAccepted(false);
+      e->ignore();
+
+      QMessageBox msgBox(this);
+      msgBox.setWindowTitle("Configuration");
+      msgBox.setStandardButtons(QMessageBox::Button::Ok);
+      msgBox.setText(QString("The proxy '%1' is not valid, use the format socks5://server:port or socks4://server:port.").arg(text));
+      msgBox.exec();
+
+      return;
+    }
+  }
+
+  for(const auto &text: config.schedule)
+  {
+    Schedule::Rule rule;
+    if(!Schedule::parse(text, rule))
+    {
+      e->setAccepted(false);
+      e->ignore();
+
+      QMessageBox msgBox(this);
+      msgBox.setWindowTitle("Configuration");
+      msgBox.setStandardButtons(QMessageBox::Button::Ok);
+      msgBox.setText(QString("The schedule rule '%1' is not valid, use the format '<days> <hh:mm>-<hh:mm> [rate=<KB/s>] [active=<count>] [pause]'.").arg(text));
+      msgBox.exec();
+
+      return;
+    }
+  }
+
   accept();
 }
 
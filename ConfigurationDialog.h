@@ -80,6 +80,8 @@ class ConfigurationDialog
      * @brief Connects signals to slots. 
      */
     void connectSignals();
+
+    Utils::Configuration m_config; /** configuration with the values not editable in the dialog. */
 };
 
 #endif
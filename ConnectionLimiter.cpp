@@ -0,0 +1,87 @@
+/*
+ File: ConnectionLimiter.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ConnectionLimiter.h>
+#include <Metrics.h>
+
+//----------------------------------------------------------------------------
+ConnectionLimiter::ConnectionLimiter(const Utils::Configuration &config)
+: m_config{config}
+{
+}
+
+//----------------------------------------------------------------------------
+QString ConnectionLimiter::proxyKey(const Utils::ItemInformation *item)
+{
+  if(!item || item->server.isEmpty()) return QString();
+  return QString("%1:%2").arg(item->server.toLower()).arg(item->port);
+}
+
+//----------------------------------------------------------------------------
+bool ConnectionLimiter::canOpen(const QUrl &url, const Utils::ItemInformation *item) const
+{
+  const auto hostLimit = static_cast<int>(m_config.maxConnectionsPerHost);
+  const auto proxyLimit = static_cast<int>(m_config.maxConnectionsPerProxy);
+
+  if(hostLimit > 0 && m_hosts.value(hostKey(url), 0) >= hostLimit)
+    return false;
+
+  const auto proxy = proxyKey(item);
+  return proxy.isEmpty() || proxyLimit <= 0 || m_proxies.value(proxy, 0) < proxyLimit;
+}
+
+//----------------------------------------------------------------------------
+ConnectionLimiter::Connection ConnectionLimiter::open(const QUrl &url, const Utils::ItemInformation *item)
+{
+  Connection connection;
+  if(!canOpen(url, item))
+  {
+    Metrics::add("connections delayed by limits", 1);
+    return connection;
+  }
+
+  connection.host = hostKey(url);
+  connection.proxy = proxyKey(item);
+  connection.open = true;
+
+  ++m_hosts[connection.host];
+  if(!connection.proxy.isEmpty())
+    ++m_proxies[connection.proxy];
+
+  return connection;
+}
+
+//----------------------------------------------------------------------------
+void ConnectionLimiter::close(Connection &connection)
+{
+  if(!connection.open) return;
+  connection.open = false;
+
+  auto release = [](QHash<QString, int> &counts, const QString &key)
+  {
+    auto it = counts.find(key);
+    if(it == counts.end()) return;
+    if(--it.value() <= 0) counts.erase(it);
+  };
+
+  release(m_hosts, connection.host);
+  if(!connection.proxy.isEmpty())
+    release(m_proxies, connection.proxy);
+}
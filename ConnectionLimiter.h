@@ -0,0 +1,99 @@
+/*
+ File: ConnectionLimiter.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CONNECTION_LIMITER_H_
+#define _CONNECTION_LIMITER_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief Counts the curl connections open to each host and through each proxy, single transfers
+ * and ranges alike, and enforces the limits of the configuration.
+ */
+class ConnectionLimiter
+{
+  public:
+    /**
+     * @brief Open connection, used to close it with the same host and proxy it was opened with.
+     */
+    struct Connection
+    {
+      QString host;  /** host of the url. */
+      QString proxy; /** proxy server:port or empty if none. */
+      bool open = false; /** true if the connection is counted. */
+    };
+
+    /**
+     * @brief ConnectionLimiter class constructor.
+     * @param config Application configuration reference.
+     */
+    explicit ConnectionLimiter(const Utils::Configuration &config);
+
+    /**
+     * @brief Returns true if a connection to the url through the proxy of the item can be opened.
+     * @param url Url to connect to.
+     * @param item Item information, for the proxy.
+     */
+    bool canOpen(const QUrl &url, const Utils::ItemInformation *item) const;
+
+    /**
+     * @brief Counts a new connection if the limits allow it. Returns a closed connection otherwise.
+     * @param url Url to connect to.
+     * @param item Item information, for the proxy.
+     */
+    Connection open(const QUrl &url, const Utils::ItemInformation *item);
+
+    /**
+     * @brief Stops counting the connection, if open.
+     * @param connection Connection returned by open().
+     */
+    void close(Connection &connection);
+
+    /**
+     * @brief Returns the number of connections open to the host.
+     * @param host Host name.
+     */
+    int hostConnections(const QString &host) const
+    { return m_hosts.value(host.toLower(), 0); }
+
+    /**
+     * @brief Returns the host of the url as counted by the limiter.
+     * @param url Url.
+     */
+    static QString hostKey(const QUrl &url)
+    { return url.host().toLower(); }
+
+  private:
+    /**
+     * @brief Returns the proxy of the item as counted by the limiter, empty if none.
+     * @param item Item information.
+     */
+    static QString proxyKey(const Utils::ItemInformation *item);
+
+    const Utils::Configuration &m_config; /** application configuration reference. */
+    QHash<QString, int> m_hosts;          /** open connections by host. */
+    QHash<QString, int> m_proxies;        /** open connections by proxy. */
+};
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ File: ConnectivityMonitor.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ConnectivityMonitor.h>
+#include <Metrics.h>
+#include <Tracer.h>
+
+// Qt
+#include <QTcpSocket>
+
+// C++
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+const int PROBE_INTERVAL_MS = 5000;
+const int PROBE_TIMEOUT_MS = 5000;
+const size_t MAX_FAILED_HOSTS = 4;
+const int PROGRESS_WINDOW_MS = 10000; // a transfer that received data in this time proves the network is up.
+
+//----------------------------------------------------------------------------
+ConnectivityMonitor::ConnectivityMonitor(QObject *parent)
+: QObject(parent)
+, m_online{true}
+, m_systemOffline{false}
+, m_probes{0}
+, m_successes{0}
+, m_targets{0}
+{
+  m_timer.setInterval(PROBE_INTERVAL_MS);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(probe()));
+
+  if(QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Reachability))
+  {
+    auto information = QNetworkInformation::instance();
+    connect(information, SIGNAL(reachabilityChanged(QNetworkInformation::Reachability)), this, SLOT(onReachabilityChanged(QNetworkInformation::Reachability)));
+    onReachabilityChanged(information->reachability());
+  }
+}
+
+//----------------------------------------------------------------------------
+void ConnectivityMonitor::setProbeHosts(const QStringList &hosts)
+{
+  m_hosts.clear();
+
+  for(const auto &text: hosts)
+  {
+    const auto separator = text.lastIndexOf(':');
+    bool valid = false;
+    const auto port = text.mid(separator + 1).toUShort(&valid);
+    if(separator <= 0 || !valid || port == 0) continue;
+
+    m_hosts.emplace_back(text.left(separator).trimmed().toLower(), port);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ConnectivityMonitor::reportFailure(const QString &host, const quint16 port)
+{
+  if(!m_online || host.isEmpty()) return;
+
+  const Target target{host.toLower(), port};
+  m_working.erase(std::remove(m_working.begin(), m_working.end(), target), m_working.end());
+  m_failed.erase(std::remove(m_failed.begin(), m_failed.end(), target), m_failed.end());
+  m_failed.push_back(target);
+  while(m_failed.size() > MAX_FAILED_HOSTS)
+    m_failed.pop_front();
+
+  probe();
+}
+
+//----------------------------------------------------------------------------
+void ConnectivityMonitor::reportProgress(const QString &host, const quint16 port)
+{
+  m_progress.start();
+
+  if(!host.isEmpty())
+  {
+    const Target target{host.toLower(), port};
+    m_failed.erase(std::remove(m_failed.begin(), m_failed.end(), target), m_failed.end());
+    if(std::find(m_working.cbegin(), m_working.cend(), target) == m_working.cend())
+    {
+      m_working.push_back(target);
+      while(m_working.size() > MAX_FAILED_HOSTS)
+        m_working.pop_front();
+    }
+  }
+
+  // data received proves the network is up whatever the probes said.
+  if(!m_online) setOnline(true);
+}
+
+//----------------------------------------------------------------------------
+bool ConnectivityMonitor::isNetworkError(const int code)
+{
+  switch(code)
+  {
+    case 5:  // couldn't resolve proxy.
+    case 6:  // couldn't resolve host.
+    case 7:  // couldn't connect.
+    case 28: // operation timeout.
+    case 35: // SSL connect error.
+    case 52: // empty reply from server.
+    case 55: // failed sending network data.
+    case 56: // failure in receiving network data.
+    case 97: // proxy handshake error.
+      return true;
+    default:
+      break;
+  }
+
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void ConnectivityMonitor::probe()
+{
+  if(m_probes > 0) return;
+
+  std::vector<Target> targets(m_hosts.cbegin(), m_hosts.cend());
+  for(const auto hosts: {&m_working, &m_failed})
+  {
+    for(const auto &target: *hosts)
+    {
+      if(std::find(targets.cbegin(), targets.cend(), target) == targets.cend())
+        targets.push_back(target);
+    }
+  }
+
+  // without hosts to probe only the system knows.
+  if(targets.empty())
+  {
+    if(!m_online && !m_systemOffline) setOnline(true);
+    return;
+  }
+
+  m_targets = static_cast<int>(targets.size());
+  m_probes = m_targets;
+  m_successes = 0;
+
+  for(const auto &target: targets)
+  {
+    auto socket = new QTcpSocket(this);
+    auto done = std::make_shared<bool>(false);
+
+    auto finish = [this, socket, done](const bool success)
+    {
+      if(*done) return;
+      *done = true;
+
+      socket->abort();
+      socket->deleteLater();
+      onProbeResult(success);
+    };
+
+    connect(socket, &QTcpSocket::connected, this, [finish]() { finish(true); });
+    connect(socket, &QTcpSocket::errorOccurred, this, [finish]() { finish(false); });
+    QTimer::singleShot(PROBE_TIMEOUT_MS, socket, [finish]() { finish(false); });
+
+    socket->connectToHost(target.first, target.second);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ConnectivityMonitor::onProbeResult(const bool success)
+{
+  if(success) ++m_successes;
+  if(--m_probes > 0) return;
+
+  if(m_successes > 0)
+  {
+    setOnline(true);
+    return;
+  }
+
+  // the hosts that failed can be servers down: the network is down if the system says so, or if no
+  // transfer is receiving data and the configured hosts or the ones that worked don't answer either.
+  const auto receiving = m_progress.isValid() && m_progress.elapsed() < PROGRESS_WINDOW_MS;
+  const auto references = !m_hosts.empty() || !m_working.empty();
+  setOnline(!m_systemOffline && (receiving || !references));
+}
+
+//----------------------------------------------------------------------------
+void ConnectivityMonitor::onReachabilityChanged(QNetworkInformation::Reachability reachability)
+{
+  m_systemOffline = (reachability == QNetworkInformation::Reachability::Disconnected);
+
+  if(m_systemOffline)
+    setOnline(false);
+  else if(!m_online)
+    probe();
+}
+
+//----------------------------------------------------------------------------
+void ConnectivityMonitor::setOnline(const bool online)
+{
+  if(m_online == online) return;
+  m_online = online;
+
+  if(!online)
+  {
+    Tracer::instant("network down");
+    Metrics::add("network outages", 1);
+
+    m_outage.start();
+    m_timer.start();
+    emit offline();
+  }
+  else
+  {
+    Tracer::instant("network up");
+    Metrics::add("network outage seconds", m_outage.elapsed() / 1000);
+
+    m_timer.stop();
+    m_failed.clear();
+    emit online();
+  }
+}
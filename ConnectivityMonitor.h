@@ -0,0 +1,144 @@
+/*
+ File: ConnectivityMonitor.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CONNECTIVITY_MONITOR_H_
+#define _CONNECTIVITY_MONITOR_H_
+
+// Qt
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QNetworkInformation>
+
+// C++
+#include <deque>
+#include <utility>
+
+/**
+ * @brief Detects network outages. The system reachability is used when available and the
+ * network errors of the transfers trigger TCP probes to the configured probe hosts, the hosts
+ * that received data recently and the hosts that failed: the network is down if none of them
+ * answers while no transfer is receiving data. The hosts that failed alone never decide, they can
+ * be servers down. While down the probes are repeated until one of them answers or a transfer
+ * receives data.
+ */
+class ConnectivityMonitor
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /**
+     * @brief ConnectivityMonitor class constructor.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    explicit ConnectivityMonitor(QObject *parent = nullptr);
+
+    /**
+     * @brief ConnectivityMonitor class virtual destructor.
+     */
+    virtual ~ConnectivityMonitor()
+    {};
+
+    /**
+     * @brief Returns true if the network is up.
+     */
+    bool isOnline() const
+    { return m_online; }
+
+    /**
+     * @brief Sets the hosts probed with the ones that failed.
+     * @param hosts Hosts in 'host:port' format, the invalid ones are ignored.
+     */
+    void setProbeHosts(const QStringList &hosts);
+
+    /**
+     * @brief Reports a transfer that failed with a network error, the network is probed.
+     * @param host Host or proxy the transfer connects to.
+     * @param port TCP port.
+     */
+    void reportFailure(const QString &host, const quint16 port);
+
+    /**
+     * @brief Reports a transfer receiving data, the network isn't down while they do. The host is
+     * probed in the next outages.
+     * @param host Host or proxy the transfer connects to.
+     * @param port TCP port.
+     */
+    void reportProgress(const QString &host, const quint16 port);
+
+    /**
+     * @brief Returns true if the curl exit code is caused by the network: the host can't be
+     * resolved or reached, or the connection is lost.
+     * @param code curl exit code.
+     */
+    static bool isNetworkError(const int code);
+
+  signals:
+    /**
+     * @brief Emitted when the network goes down.
+     */
+    void offline();
+
+    /**
+     * @brief Emitted when the network is up again.
+     */
+    void online();
+
+  private slots:
+    /**
+     * @brief Probes the hosts, unless they're already being probed.
+     */
+    void probe();
+
+    /**
+     * @brief Handles the changes of the system reachability.
+     * @param reachability Reachability value.
+     */
+    void onReachabilityChanged(QNetworkInformation::Reachability reachability);
+
+  private:
+    /**
+     * @brief Handles the result of a probe and decides once all the probes of the round finish.
+     * @param success True if the host answered.
+     */
+    void onProbeResult(const bool success);
+
+    /**
+     * @brief Changes the state and emits the signals.
+     * @param online True if the network is up.
+     */
+    void setOnline(const bool online);
+
+    using Target = std::pair<QString, quint16>;
+
+    bool m_online;                 /** true if the network is up. */
+    bool m_systemOffline;          /** true if the system reports no network. */
+    std::deque<Target> m_failed;   /** last hosts that failed with a network error. */
+    std::deque<Target> m_working;  /** last hosts that received data. */
+    std::deque<Target> m_hosts;    /** configured probe hosts. */
+    QTimer m_timer;                /** probe timer while the network is down. */
+    QElapsedTimer m_outage;        /** duration of the outage. */
+    QElapsedTimer m_progress;      /** time since a transfer last received data, invalid if none did. */
+    int m_probes;                  /** probes of the round not finished. */
+    int m_successes;               /** probes of the round that succeeded. */
+    int m_targets;                 /** hosts probed in the round. */
+};
+
+#endif
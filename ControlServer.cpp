@@ -0,0 +1,230 @@
+/*
+ File: ControlServer.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ControlServer.h>
+#include <Metrics.h>
+
+// Qt
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonArray>
+
+// C++
+#include <algorithm>
+
+const qint64 MAX_REQUEST_SIZE = 16 * 1024 * 1024;
+const qint64 MAX_UNSENT_BYTES = 1024 * 1024; // subscriber bytes not yet read before holding the events.
+const size_t MAX_QUEUED_EVENTS = 10000;     // subscriber events held before dropping them.
+const int FLUSH_INTERVAL = 100;
+
+//----------------------------------------------------------------------------
+ControlServer::ControlServer(Handler handler, QObject *parent)
+: QObject(parent)
+, m_handler{handler}
+{
+  connect(&m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+
+  m_flushTimer.setInterval(FLUSH_INTERVAL);
+  connect(&m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+//----------------------------------------------------------------------------
+bool ControlServer::listen(const QString &name)
+{
+  if(m_server.isListening()) m_server.close();
+
+  // only the user running the application can connect.
+  m_server.setSocketOptions(QLocalServer::UserAccessOption);
+  QLocalServer::removeServer(name);
+
+  return m_server.listen(name);
+}
+
+//----------------------------------------------------------------------------
+QJsonObject ControlServer::error(const QString &message)
+{
+  return QJsonObject{{"ok", false}, {"error", message}};
+}
+
+//----------------------------------------------------------------------------
+void ControlServer::onNewConnection()
+{
+  while(m_server.hasPendingConnections())
+  {
+    auto socket = m_server.nextPendingConnection();
+    connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+
+    Metrics::add("control connections", 1);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ControlServer::onReadyRead()
+{
+  auto socket = qobject_cast<QLocalSocket *>(sender());
+  if(!socket) return;
+
+  while(socket->canReadLine())
+  {
+    const auto line = socket->readLine().trimmed();
+    if(line.isEmpty()) continue;
+
+    const auto response = handle(socket, line);
+    socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n');
+  }
+
+  // a line this long is not a request.
+  if(socket->bytesAvailable() > MAX_REQUEST_SIZE)
+  {
+    socket->write(QJsonDocument(error("Request too large.")).toJson(QJsonDocument::Compact) + '\n');
+    socket->disconnectFromServer();
+  }
+}
+
+//----------------------------------------------------------------------------
+QJsonObject ControlServer::handle(QLocalSocket *socket, const QByteArray &line)
+{
+  Metrics::add("control requests", 1);
+
+  QJsonParseError parseError;
+  const auto document = QJsonDocument::fromJson(line, &parseError);
+  if(!document.isObject())
+    return error(QString("Invalid JSON request: %1").arg(parseError.errorString()));
+
+  const auto request = document.object();
+  const auto command = request.value("command").toString();
+
+  QJsonObject response;
+  if(command == "subscribe")
+  {
+    Subscriber subscriber;
+    subscriber.interval = std::max(FLUSH_INTERVAL, request.value("interval").toInt(subscriber.interval));
+    for(const auto value: request.value("items").toArray())
+      subscriber.items.insert(static_cast<quint64>(value.toInteger()));
+    subscriber.lastSend.start();
+
+    m_subscribers.insert(socket, subscriber);
+    if(!m_flushTimer.isActive()) m_flushTimer.start();
+  }
+  else if(command == "unsubscribe")
+  {
+    m_subscribers.remove(socket);
+    if(m_subscribers.isEmpty()) m_flushTimer.stop();
+  }
+  else
+    response = m_handler(request);
+
+  if(!response.contains("ok"))
+    response.insert("ok", true);
+  if(request.contains("id"))
+    response.insert("id", request.value("id"));
+
+  return response;
+}
+
+//----------------------------------------------------------------------------
+void ControlServer::publish(const quint64 id, const QJsonObject &event)
+{
+  if(m_subscribers.isEmpty()) return;
+
+  auto object = event;
+  object.insert("item", static_cast<qint64>(id));
+
+  enqueueEvent(id, QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+}
+
+//----------------------------------------------------------------------------
+void ControlServer::publishProgress(const quint64 id, const int progress)
+{
+  // only the last value of each item is kept until sent.
+  for(auto &subscriber: m_subscribers)
+  {
+    if(subscriber.overflow || (!subscriber.items.isEmpty() && !subscriber.items.contains(id))) continue;
+    subscriber.progress[id] = progress;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ControlServer::enqueueEvent(const quint64 id, const QByteArray &event)
+{
+  for(auto &subscriber: m_subscribers)
+  {
+    if(subscriber.overflow || (!subscriber.items.isEmpty() && !subscriber.items.contains(id))) continue;
+
+    // the subscriber doesn't read, drop its events.
+    if(subscriber.events.size() >= MAX_QUEUED_EVENTS)
+    {
+      subscriber.events.clear();
+      subscriber.progress.clear();
+      subscriber.overflow = true;
+      Metrics::add("control events dropped", 1);
+      continue;
+    }
+
+    subscriber.events.push_back(event);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ControlServer::flush()
+{
+  for(auto it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+  {
+    auto socket = it.key();
+    auto &subscriber = it.value();
+
+    if(subscriber.lastSend.elapsed() < subscriber.interval) continue;
+    if(subscriber.events.empty() && subscriber.progress.empty() && !subscriber.overflow) continue;
+
+    // hold the events while the subscriber hasn't read the previous ones.
+    if(socket->bytesToWrite() > MAX_UNSENT_BYTES) continue;
+
+    QByteArray data;
+    if(subscriber.overflow)
+    {
+      // the subscriber must request the list again to know the state of the items.
+      data += "{\"event\":\"overflow\"}\n";
+      subscriber.overflow = false;
+    }
+
+    for(const auto &event: subscriber.events)
+      data += event;
+    subscriber.events.clear();
+
+    for(const auto &progress: subscriber.progress)
+      data += QString("{\"event\":\"progress\",\"item\":%1,\"progress\":%2}\n").arg(progress.first).arg(progress.second).toUtf8();
+    subscriber.progress.clear();
+
+    socket->write(data);
+    subscriber.lastSend.restart();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ControlServer::onDisconnected()
+{
+  auto socket = qobject_cast<QLocalSocket *>(sender());
+  if(!socket) return;
+
+  m_subscribers.remove(socket);
+  if(m_subscribers.isEmpty()) m_flushTimer.stop();
+}
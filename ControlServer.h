@@ -0,0 +1,161 @@
+/*
+ File: ControlServer.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CONTROL_SERVER_H_
+#define _CONTROL_SERVER_H_
+
+// Qt
+#include <QObject>
+#include <QLocalServer>
+#include <QJsonObject>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// C++
+#include <functional>
+#include <deque>
+#include <map>
+
+class QLocalSocket;
+
+/**
+ * @brief Local control API. Listens on a local socket (a Unix domain socket or a Windows named
+ * pipe) for requests, one JSON object per line, and answers each one with a JSON object in a
+ * line, in the same order. The 'id' of the request, if any, is copied to the response.
+ * A connection that sends a 'subscribe' request receives the events of the items as JSON lines:
+ * progress is coalesced and sent at most once per interval, and the events are dropped for the
+ * subscribers that don't read them, that receive an 'overflow' event instead.
+ */
+class ControlServer
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** handles a request and returns the response. */
+    using Handler = std::function<QJsonObject(const QJsonObject &)>;
+
+    /**
+     * @brief ControlServer class constructor.
+     * @param handler Request handler.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    explicit ControlServer(Handler handler, QObject *parent = nullptr);
+
+    /**
+     * @brief ControlServer class virtual destructor.
+     */
+    virtual ~ControlServer()
+    {};
+
+    /**
+     * @brief Starts listening. Returns false on error.
+     * @param name Local socket name.
+     */
+    bool listen(const QString &name);
+
+    /**
+     * @brief Returns the description of the last error.
+     */
+    QString errorString() const
+    { return m_server.errorString(); }
+
+    /**
+     * @brief Returns an error response.
+     * @param message Error description.
+     */
+    static QJsonObject error(const QString &message);
+
+    /**
+     * @brief Returns true if there is any subscriber to the events.
+     */
+    bool hasSubscribers() const
+    { return !m_subscribers.empty(); }
+
+    /**
+     * @brief Sends an event of an item to the subscribers.
+     * @param id Item identifier.
+     * @param event Event object, the 'item' field is added.
+     */
+    void publish(const quint64 id, const QJsonObject &event);
+
+    /**
+     * @brief Sends the progress of an item to the subscribers, coalesced in the subscriber interval.
+     * @param id Item identifier.
+     * @param progress Progress value in [0,100].
+     */
+    void publishProgress(const quint64 id, const int progress);
+
+  private slots:
+    /**
+     * @brief Accepts the pending connections.
+     */
+    void onNewConnection();
+
+    /**
+     * @brief Sends the pending events of the subscribers whose interval has elapsed.
+     */
+    void flush();
+
+    /**
+     * @brief Removes the subscriber of the sender socket.
+     */
+    void onDisconnected();
+
+    /**
+     * @brief Answers the complete requests received by the sender socket.
+     */
+    void onReadyRead();
+
+  private:
+    /**
+     * @brief Events subscription of a connection.
+     */
+    struct Subscriber
+    {
+      int                      interval = 500; /** minimum time between sends in milliseconds. */
+      QSet<quint64>            items;          /** items of interest, empty for all. */
+      std::deque<QByteArray>   events;         /** events not sent yet. */
+      std::map<quint64, int>   progress;       /** progress not sent yet of each item. */
+      bool                     overflow = false; /** true if events have been dropped. */
+      QElapsedTimer            lastSend;       /** time since the last send. */
+    };
+
+    /**
+     * @brief Parses and handles a request line and returns the response.
+     * @param socket Connection of the request.
+     * @param line Request text.
+     */
+    QJsonObject handle(QLocalSocket *socket, const QByteArray &line);
+
+    /**
+     * @brief Adds the event to the subscribers interested in the item.
+     * @param id Item identifier.
+     * @param event Event text.
+     */
+    void enqueueEvent(const quint64 id, const QByteArray &event);
+
+    QLocalServer                         m_server;      /** local socket server. */
+    Handler                              m_handler;     /** request handler. */
+    QHash<QLocalSocket *, Subscriber>    m_subscribers; /** events subscriptions by connection. */
+    QTimer                               m_flushTimer;  /** subscribers send timer. */
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ File: FlightRecorder.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <FlightRecorder.h>
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+// C++
+#include <algorithm>
+
+//----------------------------------------------------------------------------
+FlightRecorder::FlightRecorder(const qint64 capacity)
+: m_capacity{0}
+, m_discarded{0}
+{
+  setCapacity(capacity);
+}
+
+//----------------------------------------------------------------------------
+void FlightRecorder::setCapacity(const qint64 capacity)
+{
+  m_capacity = std::max(static_cast<qint64>(0), capacity);
+  discard();
+}
+
+//----------------------------------------------------------------------------
+void FlightRecorder::append(const QByteArray &data)
+{
+  if(!isEnabled() || data.isEmpty()) return;
+
+  // a quarter of the capacity is used for the beginning of the trace.
+  const auto headCapacity = m_capacity / 4;
+  const auto tailCapacity = m_capacity - headCapacity;
+
+  auto remaining = data;
+  if(m_head.size() < headCapacity)
+  {
+    const auto count = std::min(headCapacity - m_head.size(), static_cast<qint64>(remaining.size()));
+    m_head.append(remaining.left(count));
+    remaining.remove(0, count);
+  }
+
+  if(remaining.isEmpty()) return;
+
+  m_tail.append(remaining);
+
+  // chop when the tail doubles the capacity to amortize the copies.
+  if(m_tail.size() > 2 * tailCapacity)
+  {
+    const auto excess = m_tail.size() - tailCapacity;
+    m_tail.remove(0, excess);
+    m_discarded += excess;
+  }
+}
+
+//----------------------------------------------------------------------------
+void FlightRecorder::discard()
+{
+  m_head.clear();
+  m_tail.clear();
+  m_discarded = 0;
+}
+
+//----------------------------------------------------------------------------
+QString FlightRecorder::persist(const QString &folder, const QString &name, const QString &header, const int maxFiles, const qint64 maxFolderSize)
+{
+  if(!isEnabled() || (m_head.isEmpty() && m_tail.isEmpty()))
+  {
+    discard();
+    return QString();
+  }
+
+  QDir directory(folder);
+  if(!directory.exists() && !directory.mkpath("."))
+  {
+    discard();
+    return QString();
+  }
+
+  const auto baseName = QFileInfo(name).fileName();
+  const auto filename = directory.absoluteFilePath(QString("%1.%2.log").arg(baseName).arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmsszzz")));
+
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+  {
+    discard();
+    return QString();
+  }
+
+  // the tail can be up to twice its capacity, write only the latest part.
+  const auto tailCapacity = m_capacity - (m_capacity / 4);
+  const auto skipped = std::max(static_cast<qint64>(0), m_tail.size() - tailCapacity);
+
+  file.write(header.toUtf8());
+  file.write("\n");
+  file.write(m_head);
+  if(m_discarded + skipped > 0)
+    file.write(QString("\n[... %1 bytes discarded ...]\n").arg(m_discarded + skipped).toUtf8());
+  file.write(m_tail.constData() + skipped, m_tail.size() - skipped);
+  file.close();
+
+  discard();
+
+  // rotate the traces of the item.
+  const auto itemTraces = directory.entryInfoList(QStringList{baseName + ".*.log"}, QDir::Files, QDir::Time);
+  for(int i = std::max(1, maxFiles); i < itemTraces.size(); ++i)
+    QFile::remove(itemTraces.at(i).absoluteFilePath());
+
+  // keep the folder size limited removing the oldest traces.
+  const auto allTraces = directory.entryInfoList(QStringList{"*.log"}, QDir::Files, QDir::Time);
+  qint64 folderSize = 0;
+  for(const auto &info: allTraces)
+  {
+    folderSize += info.size();
+    if(folderSize > maxFolderSize && info.absoluteFilePath() != filename)
+      QFile::remove(info.absoluteFilePath());
+  }
+
+  return filename;
+}
@@ -0,0 +1,83 @@
+/*
+ File: FlightRecorder.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FLIGHT_RECORDER_H_
+#define _FLIGHT_RECORDER_H_
+
+// Qt
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief Keeps the curl trace of the current attempt in a bounded memory buffer. The
+ * beginning of the trace (request and response headers) and the latest data are kept,
+ * the middle is discarded when the capacity is exceeded.
+ */
+class FlightRecorder
+{
+  public:
+    /**
+     * @brief FlightRecorder class constructor.
+     * @param capacity Maximum size of the trace in bytes, 0 to disable.
+     */
+    explicit FlightRecorder(const qint64 capacity = 0);
+
+    /**
+     * @brief Sets the maximum size of the trace in bytes.
+     * @param capacity Size in bytes, 0 to disable.
+     */
+    void setCapacity(const qint64 capacity);
+
+    /**
+     * @brief Returns true if the recorder is enabled and false otherwise.
+     */
+    bool isEnabled() const
+    { return m_capacity > 0; }
+
+    /**
+     * @brief Appends data to the trace.
+     * @param data Trace data.
+     */
+    void append(const QByteArray &data);
+
+    /**
+     * @brief Discards the current trace.
+     */
+    void discard();
+
+    /**
+     * @brief Writes the trace to a file in the given folder, removes the oldest traces of
+     * the same item and the oldest traces of the folder if the limits are exceeded and
+     * discards the current trace. Returns the path of the written file or empty if failed.
+     * @param folder Folder to store the traces.
+     * @param name Item name.
+     * @param header Text to write before the trace.
+     * @param maxFiles Maximum number of traces for the item.
+     * @param maxFolderSize Maximum size of the traces folder in bytes.
+     */
+    QString persist(const QString &folder, const QString &name, const QString &header, const int maxFiles, const qint64 maxFolderSize);
+
+  private:
+    qint64     m_capacity;  /** maximum trace size in bytes. */
+    QByteArray m_head;      /** beginning of the trace. */
+    QByteArray m_tail;      /** latest data of the trace. */
+    qint64     m_discarded; /** number of bytes discarded between head and tail. */
+};
+
+#endif
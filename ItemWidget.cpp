@@ -21,6 +21,14 @@
 #include <ItemWidget.h>
 #include <AddItemDialog.h>
 #include <curlErrors.h>
+#include <Tracer.h>
+#include <Metrics.h>
+#include <ProxyPool.h>
+#include <SegmentedDownload.h>
+#include <BackgroundRate.h>
+#include <Checksums.h>
+#include <ProcessLimits.h>
+#include <ArchiveExtractor.h>
 
 // Qt
 #include <QPainter>
@@ -29,28 +37,79 @@
 #include <QDir>
 #include <QMessageBox>
 #include <QFile>
+#include <QFileInfo>
 #include <QFontDatabase>
+#include <QLocale>
+#include <QThread>
+#include <QApplication>
+#include <QMouseEvent>
+#include <QMimeData>
+#include <QDrag>
+#include <QRegularExpression>
+
+// C++
+#include <memory>
+#include <algorithm>
 
 int ItemWidget::FONT_ID = -1;
+const QString ItemWidget::DRAG_MIME_TYPE = "application/x-curldownloader-item";
+
+const int CONNECTION_WAIT = 2000; // milliseconds between checks for a free connection.
+const qint64 RATE_RESTART_WAIT = 10000; // minimum milliseconds of a transfer before restarting it to change the rate limit.
+const int ACCOUNTING_INTERVAL = 2000; // milliseconds between samples of the resource usage of the processes.
+const int OUTPUT_CHECK_INTERVAL = 50; // milliseconds between checks of the writer while curl is stopped.
 
 //----------------------------------------------------------------------------
-ItemWidget::ItemWidget(const Utils::Configuration &config, Utils::ItemInformation *item, QWidget* parent, Qt::WindowFlags f)
+ItemWidget::ItemWidget(const Utils::Configuration &config, Utils::ItemInformation *item, ProxyPool *pool, ConnectionLimiter *limiter, QWidget* parent, Qt::WindowFlags f)
 : QWidget(parent, f)
 , m_item{item}
 , m_config{config}
+, m_proxyPool{pool}
+, m_limiter{limiter}
 , m_finished{false}
 , m_aborted{false}
 , m_paused{false}
+, m_offline{false}
 , m_supportsResume{ResumeType::UNKNOWN}
 , m_resumed{0}
+, m_receivedData{false}
+, m_attempts{0}
+, m_failures{0}
+, m_stalls{0}
+, m_wastedBytes{0}
+, m_fullRestarts{0}
+, m_hashFailures{0}
+, m_verifying{false}
+, m_restartRequested{false}
+, m_receivedBytes{0}
+, m_streamedBytes{0}
+, m_bytesPerSecond{0}
 , m_progressVal{0}
+, m_statusValue{Status::STARTING}
 , m_console{parent}
 , m_process{this}
+, m_outputSuspended{false}
+, m_ranges{nullptr}
+, m_singleTransfer{false}
+, m_background{nullptr}
+, m_extractor{nullptr}
+, m_appliedRate{0}
+, m_recorder{static_cast<qint64>(config.failureTraceSize) * 1024}
+, m_dragged{false}
 {
   setupUi(this);
   if(loadFont())
     applyFont();
 
+  QFile validator(validatorFile());
+  if(m_item->validator.isEmpty() && QFile::exists(temporalFile()) && validator.open(QIODevice::ReadOnly|QIODevice::Text))
+    m_item->validator = QString::fromUtf8(validator.readAll()).trimmed();
+
+  createRanges();
+
+  setBackground(m_item->background);
+  setExtract(m_item->extract);
+
   m_console.hide();
   m_console.setWindowTitle(tr("'%1' process console output.").arg(m_item->outputName));
   m_status->setTextFormat(Qt::TextFormat::RichText);
@@ -77,22 +136,40 @@ void ItemWidget::onNotesButtonPressed()
 //----------------------------------------------------------------------------
 void ItemWidget::onPlayButtonPressed()
 {
-  m_timer.stop();
-
   if(m_paused)
-  {
-    m_paused = false;
-    startProcess();
-    setStatus(Status::STARTING);
-    m_playPause->setIcon(QIcon(":/Downloader/pause.svg"));
-  }
+    resume();
   else
-  {
-    m_paused = true;
-    stopProcessImplementation();
-    setStatus(Status::PAUSED);
-    m_playPause->setIcon(QIcon(":/Downloader/play.svg"));
-  }
+    pause();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::pause()
+{
+  if(m_paused || m_finished || m_aborted) return;
+
+  m_timer.stop();
+
+  Tracer::instant("pause", traceId());
+  m_paused = true;
+  stopProcessImplementation();
+  if(m_background) m_background->stop();
+  setStatus(Status::PAUSED);
+  m_playPause->setIcon(QIcon(":/Downloader/play.svg"));
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::resume()
+{
+  if(!m_paused) return;
+
+  m_timer.stop();
+
+  Tracer::instant("resume", traceId());
+  m_paused = false;
+  m_failures = 0;
+  setStatus(Status::STARTING);
+  startProcess();
+  m_playPause->setIcon(QIcon(":/Downloader/pause.svg"));
 }
 
 //----------------------------------------------------------------------------
@@ -122,6 +199,10 @@ void ItemWidget::onErrorOcurred(QProcess::ProcessError error)
       break;
   }
 
+  // the process never started, finished won't be signaled.
+  if(error == QProcess::ProcessError::FailedToStart && m_limiter)
+    m_limiter->close(m_connection);
+
   setStatus(Status::ERROR_);
   m_console.addText("Process " + errorMessage + "\n");
 }
@@ -163,55 +244,276 @@ void ItemWidget::onFinished(int code , QProcess::ExitStatus status)
   }
 
   m_console.addText(message + "\n");
+  Tracer::asyncEnd("attempt", traceId(), "exit code", code);
+  onAccountingTimer();
+
+  if(m_limiter) m_limiter->close(m_connection);
+
+  // the temporal file is complete once the writer finishes.
+  if(m_writer)
+  {
+    m_outputSuspended = false;
+    m_outputTimer.stop();
+
+    m_writer->write(m_process.readAllStandardOutput());
+    if(!m_writer->close())
+    {
+      m_console.addText(QString("Unable to write the temporal file: %1.\n").arg(m_writer->errorString()));
+      code = 23; // CURLE_WRITE_ERROR
+    }
+
+    m_inlineHash = (code == 0) ? m_writer->hash() : QByteArray();
+    m_writer.reset();
+  }
+
+  if(code == 0 || m_paused || m_aborted)
+    m_recorder.discard();
+  else
+    persistFailureTrace(code);
+
+  m_stallTimer.stop();
+  reportThroughput();
 
   if(m_paused)
     return;
 
+  // stopped or failed because the network is down, started again when it's up.
+  if(m_offline && !m_aborted && (code != 0 || status == QProcess::ExitStatus::CrashExit))
+  {
+    m_restartRequested = false;
+    setStatus(Status::WAITING);
+    return;
+  }
+
+  if(m_restartRequested && !m_aborted)
+  {
+    m_restartRequested = false;
+    if(fullRestartsExhausted())
+    {
+      failPermanently(QString("Maximum of %1 restarts from the beginning reached.").arg(m_config.maxFullRestarts));
+      return;
+    }
+
+    setStatus(Status::RETRYING);
+    m_timer.start(0);
+    return;
+  }
+
+  // resuming a complete file is answered with a 416, the download is finished if the sizes match.
+  if(!m_finished && !m_aborted && code == 22 && !m_ranges)
+  {
+    const auto headers = Utils::readResponseHeaders(headersFile());
+    if(headers.status == 416)
+    {
+      if(!checkRemoteSize(headers))
+        return;
+
+      code = 0;
+    }
+  }
+
   if(!m_finished && !m_aborted)
     m_finished = (code == 0);
 
+  if(m_finished && !m_aborted && !m_item->hashes.isEmpty())
+  {
+    m_finished = false;
+    verifyDownload();
+    return;
+  }
+
+  // CURLE_RANGE_ERROR, the server sent the complete file instead of the requested range.
+  if(!m_finished && !m_aborted && code == 33)
+  {
+    invalidateResume();
+    return;
+  }
+
   if(!m_finished && !m_aborted)
   {
-    m_finished = (code == 0);
-    setStatus(Status::RETRYING);
-    m_console.addText(QString("Retrying in %1 seconds...\n").arg(m_config.waitSeconds));
-    m_timer.singleShot(m_config.waitSeconds*1000, this, SLOT(startProcess()));
+    scheduleRetry(code);
+  }
+  else
+  {
+    endDownload();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::endDownload()
+{
+  QFile::remove(headersFile());
+  QFile::remove(validatorFile());
+  if(m_ranges) m_ranges->removeState();
+  if(m_background) m_background->stop();
+  if(m_item->usePool && m_proxyPool) m_proxyPool->release(m_item);
+
+  if(m_extractor && m_aborted)
+  {
+    m_extractor->abort();
+    m_extractor->deleteLater();
+    m_extractor = nullptr;
+  }
+
+  if(m_aborted)
+  {
+    setStatus(Status::ABORTED);
+    m_timer.stop();
+
+    emit cancelled();
   }
   else
   {
+    setStatus(Status::FINISHED);
+    m_timer.stop();
+
+    // the files downloaded by ranges aren't written in order, extracted once complete.
+    startExtraction();
+    if(m_extractor)
+    {
+      m_extractor->finish(QDir(m_config.downloadPath).absoluteFilePath(m_item->outputName));
+    }
+
+    emit finished();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::verifyDownload()
+{
+  m_verifying = true;
+  setStatus(Status::VERIFYING);
+  m_console.addText("Verifying the hashes of the downloaded file...\n");
+  Tracer::asyncBegin("verify", traceId());
+
+  // the hash computed while writing the whole file avoids reading it again.
+  const auto inlineHash = m_item->hashes.pieces.isEmpty() ? m_inlineHash : QByteArray();
+  if(!inlineHash.isEmpty()) Metrics::add("inline hash verifications", 1);
+
+  auto result = std::make_shared<Checksums::Result>();
+  auto thread = QThread::create([result, filename = temporalFile(), hashes = m_item->hashes, inlineHash]()
+  {
+    if(!inlineHash.isEmpty())
+    {
+      result->valid = true;
+      result->fileMatches = (inlineHash == hashes.hash);
+      return;
+    }
+
+    *result = Checksums::verify(filename, hashes, true);
+  });
+
+  connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+  connect(thread, &QThread::finished, this, [this, result]()
+  {
+    m_verifying = false;
+    Tracer::asyncEnd("verify", traceId(), "bad pieces", result->badPieces());
+
     if(m_aborted)
     {
-      setStatus(Status::ABORTED);
-      m_timer.stop();
+      endDownload();
+      return;
+    }
 
-      emit cancelled();
+    if(result->valid && result->fileMatches && result->badPieces() == 0)
+    {
+      m_console.addText("The downloaded file matches the hashes.\n");
+      m_finished = true;
+      endDownload();
+      return;
     }
-    else
+
+    ++m_hashFailures;
+    Metrics::add("verification failures", 1);
+    updateTooltip();
+
+    const auto maxHashFailures = m_config.retryPolicy.maxHashFailures();
+    if(maxHashFailures > 0 && m_hashFailures >= maxHashFailures)
+    {
+      failPermanently(QString("The downloaded file doesn't match the hashes after %1 attempts.").arg(m_hashFailures));
+      return;
+    }
+
+    if(m_paused) return;
+
+    // with pieces only the ones that don't match are downloaded again, otherwise everything is.
+    if(result->pieces.empty())
     {
-      setStatus(Status::FINISHED);
-      m_timer.stop();
+      QFile file(temporalFile());
+      const auto size = file.size();
+      if(!file.resize(0) && !file.remove())
+      {
+        failPermanently(QString("Unable to truncate '%1' to download it again.").arg(QDir::toNativeSeparators(temporalFile())));
+        return;
+      }
 
-      emit finished();
+      if(m_ranges) m_ranges->removeState();
+      restartExtraction();
+      addWastedBytes(size);
     }
-  }
+    else
+    {
+      addWastedBytes(result->badPieces() * m_item->hashes.pieceLength);
+    }
+
+    m_console.addText(QString("The downloaded file doesn't match the hashes%1, downloading again...\n")
+                        .arg(result->pieces.empty() ? QString() : QString(" (%1 bad pieces)").arg(result->badPieces())));
+    setStatus(Status::RETRYING);
+    m_timer.start(0);
+  });
+
+  thread->start();
 }
 
 //----------------------------------------------------------------------------
 void ItemWidget::onTextReady()
 {
-  const auto stderrText = QString(m_process.readAllStandardError());
-  const auto stdoutText = QString(m_process.readAllStandardOutput());
+  const auto stderrData = m_process.readAllStandardError();
+  const auto stdoutData = m_process.readAllStandardOutput();
+
+  // stdout has the body when streamed.
+  if(m_writer)
+  {
+    m_writer->write(stdoutData);
+    m_streamedBytes += stdoutData.size();
+
+    // the attempt ends at the first failed write, the rest of the body would be discarded.
+    if(m_writer->hasFailed())
+    {
+      resumeOutput();
+      m_process.kill();
+    }
+    // while the writer is behind curl is stopped, the data waits in the pipe and the TCP window.
+    else if(!m_outputSuspended && m_writer->isFull() && ProcessLimits::suspend(m_process.processId(), true))
+    {
+      m_outputSuspended = true;
+      m_outputTimer.start();
+      Metrics::add("output backpressure", 1);
+    }
+  }
+
+  auto stderrText = QString(stderrData);
+  const auto stdoutText = m_writer ? QString() : QString(stdoutData);
+
+  // with the recorder enabled stderr also has the verbose output of curl, keep it and parse the latest progress line.
+  if(m_recorder.isEnabled())
+  {
+    QString progress;
+    for(const auto &line: stderrText.split(QRegularExpression("[\r\n]"), Qt::SkipEmptyParts))
+    {
+      if(isProgressLine(line)) progress = line;
+      else m_recorder.append(line.toUtf8() + '\n');
+    }
+    stderrText = progress;
+  }
 
   for(auto text: {stderrText, stdoutText})
   {
-    if(text.isEmpty()) continue;
+    if(!isProgressLine(text)) continue;
     auto parts = text.split(' ');
     parts.removeAll("");
     parts.removeAll(" ");
-    if(parts.size() < 1) continue;
-    bool isValid = false;
-    const auto percentage = parts.front().toUInt(&isValid);
-    if(!isValid || percentage > 100 || parts.size() != 12) continue;
+    const auto percentage = parts.front().toUInt();
 
     // 0 is progress, 1 is total size.
     const auto remainSize = (parts[1].isEmpty() || parts[1].compare("0") == 0) ? QString() : parts[1];
@@ -237,22 +539,62 @@ void ItemWidget::onTextReady()
       }
     }
 
+    m_receivedBytes = Utils::curlSizeToBytes(parts[3]);
+    if(!m_receivedData && parts[3].compare("0") != 0)
+    {
+      m_receivedData = true;
+
+      const auto headers = Utils::readResponseHeaders(headersFile());
+      updateValidator(headers);
+      updateResumeSupport(headers);
+      Tracer::instant("first byte", traceId());
+    }
+    Tracer::instant("progress", traceId(), "percent", percentage);
+
     updateWidget(percentage, parts[11].remove('\n').remove('\r'), parts[10]);  
+    m_bytesPerSecond = Utils::curlSizeToBytes(parts[11]);
+    if(m_background) m_background->setThroughput(m_bytesPerSecond);
     setStatus(Status::DOWNLOADING);
     m_console.addText(text + "\n");
     break;
   }
 }
 
+//----------------------------------------------------------------------------
+bool ItemWidget::isProgressLine(const QString &text)
+{
+  auto parts = text.split(' ');
+  parts.removeAll("");
+  if(parts.size() != 12) return false;
+
+  bool isValid = false;
+  const auto percentage = parts.front().toUInt(&isValid);
+  return isValid && percentage <= 100;
+}
+
 //----------------------------------------------------------------------------
 void ItemWidget::connectSignals()
 {
   connect(&m_process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(onErrorOcurred(QProcess::ProcessError)), Qt::DirectConnection);
   connect(&m_process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onFinished(int, QProcess::ExitStatus)), Qt::DirectConnection);
+  // curl closes its output when exiting, the last chance to read its usage before it's reaped.
+  connect(&m_process, SIGNAL(readChannelFinished()), this, SLOT(onAccountingTimer()));
 
   connect(&m_process, SIGNAL(readyReadStandardError()), this, SLOT(onTextReady()), Qt::DirectConnection);
   connect(&m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(onTextReady()), Qt::DirectConnection);
   
+  m_timer.setSingleShot(true);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(startProcess()));
+
+  m_accountingTimer.setInterval(ACCOUNTING_INTERVAL);
+  connect(&m_accountingTimer, SIGNAL(timeout()), this, SLOT(onAccountingTimer()));
+
+  m_stallTimer.setInterval(1000);
+  connect(&m_stallTimer, SIGNAL(timeout()), this, SLOT(onStallCheck()));
+
+  m_outputTimer.setInterval(OUTPUT_CHECK_INTERVAL);
+  connect(&m_outputTimer, SIGNAL(timeout()), this, SLOT(onOutputCheck()));
+
   connect(m_cancel, SIGNAL(pressed()), this, SLOT(stopProcess()));
   connect(m_notes, SIGNAL(pressed()), this, SLOT(onNotesButtonPressed()));
   connect(m_playPause, SIGNAL(pressed()), this, SLOT(onPlayButtonPressed()));
@@ -287,21 +629,95 @@ void ItemWidget::setStatus(ItemWidget::Status status)
     case Status::ABORTED:
       statusText = QString("<b><span style=\"color:#aa00aa;\">Aborted</span></b>");
       break;
+    case Status::VERIFYING:
+      statusText = QString("<b>Verifying</b>");
+      break;
+    case Status::WAITING:
+      statusText = QString("<b><span style=\"color:#0000aa;\">Waiting</span></b>");
+      break;
   }
 
   m_status->setText(statusText);
+
+  if(m_statusValue != status)
+  {
+    m_statusValue = status;
+    emit statusChanged();
+  }
 }
 
 //----------------------------------------------------------------------------
-void ItemWidget::startProcess()
+QString ItemWidget::statusName() const
 {
-  const QStringList protocols = {"--socks4", "--socks5"};
+  switch(m_statusValue)
+  {
+    case Status::STARTING:    return "starting";
+    case Status::DOWNLOADING: return "downloading";
+    case Status::RETRYING:    return "retrying";
+    case Status::ERROR_:      return "error";
+    case Status::FINISHED:    return "finished";
+    case Status::ABORTED:     return "aborted";
+    case Status::PAUSED:      return "paused";
+    case Status::VERIFYING:   return "verifying";
+    case Status::WAITING:     return "waiting";
+    default:
+      break;
+  }
 
-  if(m_process.state() != QProcess::ProcessState::NotRunning)
+  return "unknown";
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::startProcess()
+{
+  if(isTransferRunning())
     stopProcess();
 
+  if(m_offline)
+  {
+    setStatus(Status::WAITING);
+    return;
+  }
+
+  QDir().mkpath(m_config.metadataFolder());
+  QFile::remove(headersFile());
+
+  if(m_item->usePool && m_proxyPool && m_item->server.isEmpty() && m_proxyPool->assign(m_item))
+  {
+    m_console.addText(QString("Using proxy %1:%2 from the proxy pool.\n").arg(m_item->server).arg(m_item->port));
+    updateTooltip();
+  }
+
+  startRateProbes();
+
+  // the sources are probed again in the attempt after a single transfer.
+  if(!m_singleTransfer) createRanges();
+  m_singleTransfer = false;
+
+  if(m_ranges)
+  {
+    m_appliedRate = rateLimit();
+    m_ranges->setRateLimit(m_appliedRate);
+    ++m_attempts;
+    m_paused = false;
+    m_receivedData = false;
+    m_receivedBytes = 0;
+    m_bytesPerSecond = 0;
+    m_restartRequested = false;
+    m_speedSamples.clear();
+    m_ranges->start();
+    m_accountingTimer.start();
+
+    Tracer::asyncBegin("attempt", traceId());
+    m_attemptTime.start();
+    if(m_config.stallSpeed > 0)
+      m_stallTimer.start();
+    return;
+  }
+
   m_process.setWorkingDirectory(m_config.downloadPath);
   m_process.setProgram(m_config.curlPath);
+  ProcessLimits::apply(m_process, m_config);
   
   QStringList arguments;
   arguments << "--disable"; // Disable .curlrc
@@ -310,31 +726,147 @@ void ItemWidget::startProcess()
   arguments << "--insecure"; // Allow insecure server connections when using SSL
   arguments << "--location"; // Follow redirects
   arguments << "--show-error"; // Show error even when -s is used
-  arguments << "--retry" << "999"; // <num> Retry request if transient problems occur
-  arguments << "--retry-connrefused"; // Retry on connection refused (use with --retry)
-  arguments << "--retry-all-errors"; // Retry all errors.
-  arguments << "--retry-delay" << QString::number(m_config.waitSeconds); // <seconds> Wait time between retries
+  arguments << "--fail"; // Fail on HTTP errors instead of storing the error page, retries are decided by the retry policy.
+  arguments << "--dump-header" << headersFile(); // Response headers for the retry policy.
   arguments << "--globoff"; // Switch off the URL globbing function, parses urls with {}[] chars.  
-  arguments << "--output" << m_item->outputName + m_config.extension; // with temporal extension, if any.
-  if(!m_item->server.isEmpty() && (m_item->protocol != Utils::Protocol::NONE))
+  if(!m_config.streamOutput)
+    arguments << "--output" << m_item->outputName + m_config.extension; // with temporal extension, if any.
+  arguments << Utils::curlProxyArguments(*m_item);
+
+  QFile temporal(temporalFile());
+  if(m_supportsResume == ResumeType::NO)
   {
-    arguments << "--proxy-insecure"; // Do HTTPS proxy connections without verifying the proxy
+    // The server can't resume, restart from the beginning without a range request that will fail. Keep the
+    // connection alive with more frequent keepalive probes as any interruption means downloading everything again.
+    const auto discarded = temporal.size();
+    if(discarded > 0 && temporal.resize(0))
+    {
+      restartExtraction();
+      ++m_fullRestarts;
+      addWastedBytes(discarded);
+      m_console.addText(QString("The server can't resume, restarting from the beginning (%1 of %2).\n")
+                          .arg(m_fullRestarts).arg(m_config.maxFullRestarts > 0 ? QString::number(m_config.maxFullRestarts) : "unlimited"));
+    }
 
-    const auto serverText = QString("%1:%2").arg(m_item->server).arg(m_item->port);
-    arguments << protocols.at(static_cast<int>(m_item->protocol)) << serverText;
+    arguments << "--keepalive-time" << QString::number(m_config.nonResumableKeepAlive);
+  }
+  else if(temporal.exists())
+  {
+    // Continue if possible, the server will send the complete file if it has changed. curl doesn't know the
+    // size of the file when the body is streamed to stdout.
+    arguments << "--continue-at" << (m_config.streamOutput ? QString::number(temporal.size()) : QString("-"));
+    if(!m_item->validator.isEmpty())
+      arguments << "--header" << "If-Range: " + m_item->validator;
   }
 
-  // Continue if possible
-  if(QDir(m_config.downloadPath).exists(m_item->outputName + m_config.extension))
-    arguments << "--continue-at" << "-";
+  // Protocol trace to stderr without the body, kept in memory and only stored if the attempt fails.
+  if(m_recorder.isEnabled())
+    arguments << "--verbose" << "--trace-time";
+
+  m_appliedRate = rateLimit();
+  if(m_appliedRate > 0)
+    arguments << "--limit-rate" << QString::number(m_appliedRate);
 
   arguments << "--url" << m_item->url.toString();
 
+  // wait for a free connection to the host and proxy.
+  if(m_limiter && !m_connection.open)
+  {
+    m_connection = m_limiter->open(m_item->url, m_item);
+    if(!m_connection.open)
+    {
+      setStatus(Status::WAITING);
+      m_timer.start(CONNECTION_WAIT);
+      return;
+    }
+  }
+
+  m_inlineHash.clear();
+  if(m_config.streamOutput)
+  {
+    QCryptographicHash::Algorithm algorithm;
+    const auto hashed = !m_item->hashes.hash.isEmpty() && Checksums::algorithm(m_item->hashes.type, algorithm);
+
+    m_writer = std::make_unique<OutputWriter>(temporalFile(), static_cast<qint64>(m_config.outputBlockSize) * 1024, static_cast<qint64>(m_config.outputSyncInterval) * 1024 * 1024);
+    if(!m_writer->open(m_item->size, hashed ? &algorithm : nullptr))
+    {
+      const auto error = m_writer->errorString();
+      m_writer.reset();
+      if(m_limiter) m_limiter->close(m_connection);
+      failPermanently(QString("Unable to open the temporal file: %1.").arg(error));
+      return;
+    }
+  }
+
+  startExtraction();
+
+  ++m_attempts;
+  m_recorder.discard();
   m_paused = false;
+  m_receivedData = false;
+  m_receivedBytes = 0;
+  m_streamedBytes = 0;
+  m_bytesPerSecond = 0;
+  m_restartRequested = false;
+  m_speedSamples.clear();
   m_process.setArguments(arguments);
   m_process.start();
-  m_process.setTextModeEnabled(true);  
+  m_process.setTextModeEnabled(!m_writer);
   m_process.waitForStarted();
+
+  Tracer::asyncBegin("attempt", traceId());
+  Tracer::instant("process spawn", traceId(), "pid", m_process.processId());
+  m_accountingTimer.start();
+  onAccountingTimer();
+
+  m_attemptTime.start();
+  if(m_config.stallSpeed > 0)
+    m_stallTimer.start();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::onStallCheck()
+{
+  if(!isTransferRunning() || m_paused || m_aborted)
+    return;
+
+  // the time curl is stopped by the writer isn't a stall, a new window starts when it continues.
+  if(m_outputSuspended)
+  {
+    m_speedSamples.clear();
+    return;
+  }
+
+  // servers that can't resume lose everything when restarted, be more tolerant with them.
+  const auto factor = (m_supportsResume == ResumeType::NO) ? m_config.nonResumableStallFactor : 1;
+  const auto now = m_attemptTime.elapsed();
+  const auto window = static_cast<qint64>(m_config.stallWindow) * factor * 1000;
+  const auto gracePeriod = static_cast<qint64>(m_config.stallGracePeriod) * factor * 1000;
+
+  const auto bytes = transferredBytes();
+  m_speedSamples.emplace_back(now, bytes);
+  while(m_speedSamples.size() > 1 && now - m_speedSamples.front().first > window)
+    m_speedSamples.pop_front();
+
+  // needs a complete window after the grace period.
+  const auto &oldest = m_speedSamples.front();
+  if(now < gracePeriod + window || now - oldest.first < window - 1000)
+    return;
+
+  const auto speed = (bytes - oldest.second) * 1000 / std::max(static_cast<qint64>(1), now - oldest.first);
+  if(speed >= m_config.stallSpeed)
+    return;
+
+  ++m_stalls;
+  updateTooltip();
+
+  m_console.addText(QString("Transfer stalled (%1 bytes/s in the last %2 seconds), restarting...\n").arg(speed).arg(window / 1000));
+  Tracer::instant("stall", traceId(), "speed", speed);
+  emit stalled();
+  rotateProxy();
+
+  m_restartRequested = true;
+  stopProcessImplementation();
 }
 
 //----------------------------------------------------------------------------
@@ -371,27 +903,40 @@ void ItemWidget::stopProcess()
       return;
     }
 
-    m_cancel->setEnabled(false);
-    m_playPause->setEnabled(false);
-
-    m_aborted = true;
-    if(m_paused)
-    {
-      m_paused = false;
-      onFinished(0, QProcess::ExitStatus::NormalExit);
-    }
-    else
-    {
-      stopProcessImplementation();
-    }
+    cancel();
   }
   else
     reactivateTimer();
 }
 
+//----------------------------------------------------------------------------
+void ItemWidget::cancel()
+{
+  if(m_aborted || m_finished) return;
+
+  m_timer.stop();
+  m_cancel->setEnabled(false);
+  m_playPause->setEnabled(false);
+
+  m_aborted = true;
+
+  // nothing running that would finish the item when waiting to retry.
+  if(m_paused || (!isTransferRunning() && !m_verifying))
+  {
+    m_paused = false;
+    onFinished(0, QProcess::ExitStatus::NormalExit);
+  }
+  else
+  {
+    stopProcessImplementation();
+  }
+}
+
 //----------------------------------------------------------------------------
 void ItemWidget::paintEvent(QPaintEvent *event)
 {
+  Tracer::ScopedSpan span("repaint", traceId());
+
   const int progressXPoint = size().width() * m_progressVal/100.f;
   auto wRect = rect();
 
@@ -417,18 +962,75 @@ void ItemWidget::paintEvent(QPaintEvent *event)
 }
 
 //----------------------------------------------------------------------------
-void ItemWidget::mousePressEvent(QMouseEvent *)
+void ItemWidget::mousePressEvent(QMouseEvent *event)
 {
-  AddItemDialog dialog(this);
-  dialog.setWindowTitle("Modify item");
-  dialog.m_url->setReadOnly(true);
-  dialog.setItem(m_item);
+  m_dragStart = event->position().toPoint();
+  m_dragged = false;
+}
 
-  if(dialog.exec() == QDialog::Accepted)
+//----------------------------------------------------------------------------
+void ItemWidget::mouseMoveEvent(QMouseEvent *event)
+{
+  if(m_dragged || !(event->buttons() & Qt::LeftButton)) return;
+  if((event->position().toPoint() - m_dragStart).manhattanLength() < QApplication::startDragDistance()) return;
+
+  m_dragged = true;
+
+  // the list moves the widget on drop.
+  auto mimeData = new QMimeData();
+  mimeData->setData(DRAG_MIME_TYPE, QByteArray::number(m_item->id));
+
+  auto drag = new QDrag(this);
+  drag->setMimeData(mimeData);
+  drag->setPixmap(grab().scaledToWidth(std::min(width(), 300)));
+  drag->exec(Qt::MoveAction);
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::mouseReleaseEvent(QMouseEvent *)
+{
+  if(m_dragged)
+  {
+    m_dragged = false;
+    return;
+  }
+
+  showModifyDialog();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::setPriority(const Utils::Priority priority)
+{
+  if(m_item->priority == priority) return;
+
+  m_item->priority = priority;
+  updateTooltip();
+  emit priorityChanged();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::showModifyDialog()
+{
+  AddItemDialog dialog(this);
+  dialog.setWindowTitle("Modify item");
+  dialog.m_url->setReadOnly(true);
+  dialog.m_mirrors->setReadOnly(true);
+  dialog.m_pattern->setVisible(false);
+  dialog.setItem(m_item);
+
+  if(dialog.exec() == QDialog::Accepted)
   {
     const auto item = dialog.getItem();
+
+    // the priority, the background mode and the extraction don't need a restart of the transfer.
+    setPriority(item->priority);
+    setBackground(item->background);
+    setExtract(item->extract);
+
     if(m_item->operator!=(*item))
     {
+      if(m_item->usePool && m_proxyPool) m_proxyPool->release(m_item);
+      m_item->usePool = item->usePool;
       m_item->port = item->port;
       m_item->protocol = item->protocol;
       m_item->server = item->server;
@@ -437,6 +1039,7 @@ void ItemWidget::mousePressEvent(QMouseEvent *)
 
       // force process restart and stop timer in case is already retrying
       m_timer.stop(); 
+      if(m_ranges) m_ranges->stop();
       m_process.terminate();
       m_process.kill();
       m_process.waitForFinished();
@@ -466,6 +1069,7 @@ void ItemWidget::enterEvent(QEnterEvent* event)
 {
   QWidget::enterEvent(event);
   setCursor(Qt::ArrowCursor);
+  updateTooltip();
   QApplication::processEvents();
 }
 
@@ -509,19 +1113,603 @@ void ItemWidget::applyFont()
 //----------------------------------------------------------------------------
 void ItemWidget::stopProcessImplementation()
 {
+  // the usage since the last sample is lost once killed.
+  onAccountingTimer();
+
+  if(m_ranges)
+    m_ranges->stop();
+
   if(m_process.state() != QProcess::ProcessState::NotRunning)
   {
+    resumeOutput();
     m_process.terminate();
     m_process.kill();
     m_process.waitForFinished();
   }
 }
 
+//----------------------------------------------------------------------------
+void ItemWidget::onRangesProgress(qint64 downloaded, qint64 total, qint64 speed)
+{
+  if(total <= 0) return;
+
+  // stall detection uses the bytes of the current attempt.
+  if(!m_receivedData && downloaded > 0)
+  {
+    m_receivedData = true;
+    m_speedSamples.clear();
+    Tracer::instant("first byte", traceId());
+  }
+  m_receivedBytes = downloaded;
+  m_bytesPerSecond = speed;
+  if(m_background) m_background->setThroughput(speed);
+
+  const auto percentage = static_cast<unsigned int>(downloaded * 100 / total);
+  Tracer::instant("progress", traceId(), "percent", percentage);
+
+  QString remainText;
+  if(speed > 0)
+  {
+    const auto seconds = (total - downloaded) / speed;
+    remainText = QString("%1:%2:%3").arg(seconds / 3600, 2, 10, QChar('0')).arg((seconds / 60) % 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'));
+  }
+
+  updateWidget(percentage, QLocale().formattedDataSize(speed, 1, QLocale::DataSizeTraditionalFormat), remainText);
+  setStatus(Status::DOWNLOADING);
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::onRangesFinished(int code)
+{
+  onFinished(code, QProcess::ExitStatus::NormalExit);
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::onRangesUnsupported()
+{
+  // a single transfer resumes at the end of the file, the holes of the ranges would be kept.
+  if(m_ranges->hasPartialFile())
+  {
+    QFile file(temporalFile());
+    const auto size = file.size();
+    if(file.exists() && !file.resize(0))
+    {
+      m_console.addText(QString("Unable to truncate the temporal file '%1'.\n").arg(QDir::toNativeSeparators(temporalFile())));
+      // CURLE_WRITE_ERROR
+      onRangesFinished(23);
+      return;
+    }
+
+    m_console.addText("The ranges downloaded are discarded, downloading from the url.\n");
+    m_ranges->removeState();
+    addWastedBytes(size);
+    restartExtraction();
+  }
+
+  Tracer::asyncEnd("attempt", traceId(), "exit code", 0);
+  m_stallTimer.stop();
+
+  m_ranges->deleteLater();
+  m_ranges = nullptr;
+  m_singleTransfer = true;
+
+  startProcess();
+}
+
+//----------------------------------------------------------------------------
+qint64 ItemWidget::speed() const
+{
+  return (isTransferRunning() && !m_paused) ? m_bytesPerSecond : 0;
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::setMaxSegments(const unsigned int segments)
+{
+  if(m_ranges) m_ranges->setMaxConnections(segments);
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::setBackground(const bool background)
+{
+  m_item->background = background;
+  if(background == (m_background != nullptr)) return;
+
+  if(background)
+  {
+    m_background = new BackgroundRate(this);
+    connect(m_background, SIGNAL(rateChanged(qint64)), this, SLOT(updateRateLimit()));
+    if(isTransferRunning()) startRateProbes();
+  }
+  else
+  {
+    m_background->deleteLater();
+    m_background = nullptr;
+  }
+
+  updateRateLimit();
+  updateTooltip();
+}
+
+//----------------------------------------------------------------------------
+qint64 ItemWidget::rateLimit() const
+{
+  const auto scheduled = m_config.transferRateLimit;
+  const auto background = m_background ? m_background->rate() : 0;
+  if(scheduled > 0 && background > 0) return std::min(scheduled, background);
+
+  return std::max(scheduled, background);
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::updateRateLimit()
+{
+  const auto limit = rateLimit();
+  if(m_background) updateTooltip();
+
+  if(m_ranges)
+  {
+    m_ranges->setRateLimit(limit);
+    return;
+  }
+
+  if(limit == m_appliedRate || m_process.state() == QProcess::ProcessState::NotRunning || m_restartRequested || m_paused)
+    return;
+
+  // restarts lose the connection, only for big changes of servers that can resume.
+  if(m_supportsResume != ResumeType::YES || m_attemptTime.elapsed() < RATE_RESTART_WAIT)
+    return;
+
+  if(m_appliedRate > 0 && limit > 0)
+  {
+    const auto ratio = static_cast<double>(limit) / m_appliedRate;
+    if(ratio > 0.67 && ratio < 1.5) return;
+
+    // a higher limit is useless if the current one isn't reached.
+    if(ratio > 1 && m_bytesPerSecond < m_appliedRate * 0.8) return;
+  }
+
+  m_console.addText(QString("Restarting the transfer to change the rate limit to %1.\n")
+                      .arg(limit > 0 ? QLocale().formattedDataSize(limit) + "/s" : QString("none")));
+  Tracer::instant("rate limit", traceId(), "bytes per second", limit);
+  Metrics::add("rate limit restarts", 1);
+
+  m_restartRequested = true;
+  stopProcessImplementation();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::onAccountingTimer()
+{
+  QList<qint64> pids;
+  if(m_process.state() != QProcess::ProcessState::NotRunning)
+    pids << m_process.processId();
+  if(m_ranges)
+    pids << m_ranges->processIds();
+
+  m_accounting.sample(pids);
+  if(pids.isEmpty())
+    m_accountingTimer.stop();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::setOffline(const bool offline)
+{
+  if(m_offline == offline) return;
+  m_offline = offline;
+
+  if(m_paused || m_finished || m_aborted || m_verifying) return;
+
+  if(offline)
+  {
+    Tracer::instant("offline", traceId());
+    m_timer.stop();
+    if(m_background) m_background->stop();
+    if(isTransferRunning())
+      stopProcessImplementation();
+    setStatus(Status::WAITING);
+  }
+  else
+  {
+    // the failures of the outage don't count for the backoff.
+    Tracer::instant("online", traceId());
+    m_failures = 0;
+    setStatus(Status::STARTING);
+    m_timer.start(0);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::setExtract(const bool extract)
+{
+  const auto changed = m_item->extract != extract;
+  m_item->extract = extract;
+
+  if(!extract && m_extractor)
+  {
+    m_extractor->abort();
+    m_extractor->deleteLater();
+    m_extractor = nullptr;
+  }
+
+  if(changed) updateTooltip();
+  if(!extract || m_finished || m_aborted) return;
+
+  if(ArchiveExtractor::format(m_item->outputName) == ArchiveExtractor::Format::NONE)
+  {
+    m_console.addText(QString("'%1' is not a tar, tar.gz, tar.zst or zip archive, it won't be extracted.\n").arg(m_item->outputName));
+    return;
+  }
+
+  if(m_process.state() != QProcess::ProcessState::NotRunning) startExtraction();
+}
+
+//----------------------------------------------------------------------------
+ArchiveExtractor *ItemWidget::extractor() const
+{
+  return m_extractor.data();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::startExtraction()
+{
+  if(!m_item->extract || (m_ranges && !m_finished)) return;
+
+  const auto format = ArchiveExtractor::format(m_item->outputName);
+  if(format == ArchiveExtractor::Format::NONE) return;
+
+  if(!m_extractor && !ArchiveExtractor::isSupported(m_config.extractorPath, format))
+  {
+    m_console.addText(QString("Zip archives need bsdtar, '%1' can't extract '%2'.\n").arg(m_config.extractorPath).arg(m_item->outputName));
+    return;
+  }
+
+  // the output name can change with the item.
+  if(m_extractor && m_extractor->filename() != temporalFile())
+  {
+    m_extractor->abort();
+    m_extractor->deleteLater();
+    m_extractor = nullptr;
+  }
+
+  if(!m_extractor)
+  {
+    const auto folder = QDir(m_config.downloadPath).absoluteFilePath(ArchiveExtractor::baseName(m_item->outputName));
+    m_extractor = new ArchiveExtractor(m_config.extractorPath, temporalFile(), folder, format, this);
+    connect(m_extractor, SIGNAL(finished(bool, const QString &)), this, SLOT(onExtracted(bool, const QString &)));
+    m_console.addText(QString("Extracting to '%1' while downloading.\n").arg(QDir::toNativeSeparators(folder)));
+  }
+
+  m_extractor->start();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::restartExtraction()
+{
+  if(!m_extractor) return;
+
+  m_console.addText("The temporal file has been truncated, extracting the archive again.\n");
+  m_extractor->restart();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::onExtracted(bool success, const QString &message)
+{
+  m_console.addText(message + "\n");
+
+  // a failed extractor is started again with the next attempt.
+  if(!success && m_extractor.data() == sender())
+  {
+    m_extractor->deleteLater();
+    m_extractor = nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::startRateProbes()
+{
+  if(!m_background) return;
+
+  // the queue that matters is the one in the path to the proxy, if any.
+  QString host;
+  quint16 port;
+  Utils::connectionTarget(*m_item, host, port);
+  m_background->start(host, port);
+}
+
+//----------------------------------------------------------------------------
+qint64 ItemWidget::transferredBytes() const
+{
+  // the sizes of the curl progress meter have only three significant digits.
+  if(m_ranges) return m_receivedBytes;
+  if(m_writer) return m_streamedBytes;
+
+  return QFileInfo(temporalFile()).size();
+}
+
+//----------------------------------------------------------------------------
+bool ItemWidget::isTransferRunning() const
+{
+  return m_process.state() != QProcess::ProcessState::NotRunning || (m_ranges && m_ranges->isRunning());
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::persistFailureTrace(const int code)
+{
+  if(!m_recorder.isEnabled()) return;
+
+  const auto header = QString("Attempt %1 of '%2' finished with code %3 (%4).\n%5\n")
+                        .arg(m_attempts).arg(m_item->outputName).arg(code).arg(curlErrorCodeToText(code))
+                        .arg((m_ranges ? m_ranges->lastArguments() : m_process.arguments()).join(' '));
+
+  const auto filename = m_recorder.persist(m_config.failureTracesFolder(), m_item->outputName, header,
+                                           m_config.failureTracesPerItem, static_cast<qint64>(m_config.failureTracesFolderSize) * 1024 * 1024);
+
+  if(!filename.isEmpty())
+    m_console.addText(QString("Failure trace stored in '%1'.\n").arg(QDir::toNativeSeparators(filename)));
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::scheduleRetry(const int code)
+{
+  emit failed(code);
+
+  // the network went down while receiving, it's started again when it's up.
+  if(m_offline) return;
+
+  const auto headers = Utils::readResponseHeaders(headersFile());
+
+  // only consecutive failures without progress increase the backoff.
+  if(m_receivedData) m_failures = 0;
+  ++m_failures;
+
+  const auto decision = m_config.retryPolicy.decide(code, headers.status, headers.retryAfter(), m_failures, m_config.waitSeconds);
+  const auto logText = QString("Retry policy: %1.").arg(decision.reason);
+
+  if(decision.action == RetryPolicy::Action::PERMANENT)
+  {
+    failPermanently(logText);
+    return;
+  }
+
+  if(fullRestartsExhausted())
+  {
+    failPermanently(QString("Maximum of %1 restarts from the beginning reached.").arg(m_config.maxFullRestarts));
+    return;
+  }
+
+  // a different proxy doesn't need to wait for the failing one. Only the errors of the connection count
+  // against the proxy: couldn't resolve proxy, couldn't connect, timeout, receive error and proxy handshake.
+  auto delaySeconds = decision.delaySeconds;
+  const auto proxyError = headers.status < 400 && QList<int>{5, 7, 28, 56, 97}.contains(code);
+  if(decision.action == RetryPolicy::Action::TRANSIENT && proxyError && rotateProxy())
+    delaySeconds = std::min(delaySeconds, m_config.waitSeconds);
+
+  setStatus(Status::RETRYING);
+  m_console.addText(logText + QString(" Retrying in %1 seconds...\n").arg(delaySeconds));
+  Tracer::instant("retry scheduled", traceId(), "delay ms", delaySeconds * 1000);
+  m_timer.start(delaySeconds * 1000);
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::failPermanently(const QString &reason)
+{
+  m_console.addText(reason + " Not retrying, press play to try again.\n");
+  Tracer::instant("permanent failure", traceId());
+
+  m_paused = true;
+  setStatus(Status::ERROR_);
+  m_playPause->setIcon(QIcon(":/Downloader/play.svg"));
+}
+
+//----------------------------------------------------------------------------
+bool ItemWidget::fullRestartsExhausted() const
+{
+  return m_supportsResume == ResumeType::NO && m_config.maxFullRestarts > 0 && m_fullRestarts >= m_config.maxFullRestarts;
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::addWastedBytes(const qint64 bytes)
+{
+  if(bytes <= 0) return;
+
+  m_wastedBytes += bytes;
+  Metrics::add("wasted bytes", bytes);
+  updateTooltip();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::onOutputCheck()
+{
+  if(m_writer && !m_writer->isDrained() && !m_writer->hasFailed()) return;
+
+  resumeOutput();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::resumeOutput()
+{
+  if(!m_outputSuspended) return;
+
+  m_outputSuspended = false;
+  m_outputTimer.stop();
+  if(m_process.state() != QProcess::ProcessState::NotRunning)
+    ProcessLimits::suspend(m_process.processId(), false);
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::createRanges()
+{
+  // pieces of a manifest are verified and downloaded again by ranges.
+  if(m_ranges || (m_item->mirrors.isEmpty() && m_item->hashes.pieces.isEmpty())) return;
+
+  m_ranges = new SegmentedDownload(m_config, m_item, m_limiter, this);
+  connect(m_ranges, SIGNAL(progress(qint64, qint64, qint64)), this, SLOT(onRangesProgress(qint64, qint64, qint64)));
+  connect(m_ranges, SIGNAL(finished(int)), this, SLOT(onRangesFinished(int)));
+  connect(m_ranges, SIGNAL(unsupported()), this, SLOT(onRangesUnsupported()));
+  connect(m_ranges, SIGNAL(message(const QString &)), &m_console, SLOT(addText(const QString &)));
+  connect(m_ranges, SIGNAL(processStarted()), this, SLOT(onAccountingTimer()));
+}
+
+//----------------------------------------------------------------------------
+bool ItemWidget::rotateProxy()
+{
+  if(!m_item->usePool || !m_proxyPool) return false;
+
+  m_proxyPool->reportFailure(m_item);
+
+  const auto previous = QString("%1:%2").arg(m_item->server).arg(m_item->port);
+  if(!m_proxyPool->assign(m_item)) return false;
+
+  m_console.addText(QString("Switching proxy from %1 to %2:%3.\n").arg(previous).arg(m_item->server).arg(m_item->port));
+  Tracer::instant("proxy switch", traceId());
+  updateTooltip();
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::reportThroughput()
+{
+  if(!m_item->usePool || !m_proxyPool || !m_attemptTime.isValid()) return;
+
+  const auto elapsed = m_attemptTime.elapsed();
+  if(elapsed > 0 && m_receivedBytes > 0)
+    m_proxyPool->reportThroughput(m_item, m_receivedBytes * 1000.0 / elapsed);
+}
+
+//----------------------------------------------------------------------------
+QString ItemWidget::headersFile() const
+{
+  return QDir(m_config.metadataFolder()).absoluteFilePath(m_item->outputName + ".headers");
+}
+
+//----------------------------------------------------------------------------
+QString ItemWidget::temporalFile() const
+{
+  return QDir(m_config.downloadPath).absoluteFilePath(m_item->outputName + m_config.extension);
+}
+
+//----------------------------------------------------------------------------
+QString ItemWidget::validatorFile() const
+{
+  return QDir(m_config.metadataFolder()).absoluteFilePath(m_item->outputName + ".validator");
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::updateValidator(const Utils::ResponseHeaders &headers)
+{
+  const auto validator = headers.validator();
+
+  if(validator.isEmpty() || (!m_item->validator.isEmpty() && headers.status != 200))
+    return;
+
+  if(validator != m_item->validator)
+  {
+    m_item->validator = validator;
+
+    QFile file(validatorFile());
+    if(file.open(QIODevice::WriteOnly|QIODevice::Truncate|QIODevice::Text))
+      file.write(validator.toUtf8());
+
+    m_console.addText(QString("Resume validator: %1\n").arg(validator));
+  }
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::updateResumeSupport(const Utils::ResponseHeaders &headers)
+{
+  if(m_supportsResume != ResumeType::UNKNOWN) return;
+
+  const auto acceptRanges = headers.headers.value("accept-ranges").toLower();
+  if(headers.status == 206 || acceptRanges == "bytes")
+    m_supportsResume = ResumeType::YES;
+  else if(acceptRanges == "none")
+    m_supportsResume = ResumeType::NO;
+  else
+    return;
+
+  updateTooltip();
+}
+
+//----------------------------------------------------------------------------
+void ItemWidget::invalidateResume()
+{
+  QFile file(temporalFile());
+  const auto size = file.size();
+
+  if(!file.resize(0))
+  {
+    failPermanently(QString("Unable to truncate '%1' to download it again.").arg(QDir::toNativeSeparators(temporalFile())));
+    return;
+  }
+  restartExtraction();
+
+  // without a validator the server just doesn't support ranges.
+  if(m_item->validator.isEmpty())
+    m_supportsResume = ResumeType::NO;
+
+  addWastedBytes(size);
+  m_item->validator.clear();
+  QFile::remove(validatorFile());
+
+  m_console.addText(QString("The server sent the complete file instead of resuming, the remote file has changed or ranges are not supported. "
+                            "Discarded %1 bytes, restarting from the beginning...\n").arg(size));
+  Tracer::instant("resume invalidated", traceId(), "wasted bytes", size);
+
+  setStatus(Status::RETRYING);
+  m_timer.start(0);
+}
+
+//----------------------------------------------------------------------------
+bool ItemWidget::checkRemoteSize(const Utils::ResponseHeaders &headers)
+{
+  // 'bytes */<size>' in the response of an unsatisfiable range.
+  const auto range = headers.headers.value("content-range").trimmed();
+  auto remoteSize = m_item->size;
+  if(range.startsWith("bytes */"))
+    remoteSize = range.mid(8).toLongLong();
+
+  QFile file(temporalFile());
+  const auto size = file.size();
+  if(remoteSize > 0 && size == remoteSize)
+  {
+    m_console.addText("The server can't resume because the file is already complete.\n");
+    return true;
+  }
+
+  // the remote file is shorter, it has changed.
+  if(!file.resize(0))
+  {
+    failPermanently(QString("Unable to truncate '%1' to download it again.").arg(QDir::toNativeSeparators(temporalFile())));
+    return false;
+  }
+  restartExtraction();
+
+  addWastedBytes(size);
+  m_item->validator.clear();
+  QFile::remove(validatorFile());
+
+  m_console.addText(QString("The server can't resume from %1 bytes, the remote file has %2 bytes. Restarting from the beginning...\n")
+                      .arg(size).arg(remoteSize > 0 ? QString::number(remoteSize) : QString("an unknown number of")));
+  Tracer::instant("resume invalidated", traceId(), "wasted bytes", size);
+
+  setStatus(Status::RETRYING);
+  m_timer.start(0);
+  return false;
+}
+
 //----------------------------------------------------------------------------
 void ItemWidget::updateTooltip()
 {
   auto toText = [](const ResumeType &value){ return value == ResumeType::UNKNOWN ? "Unknown" : (value == ResumeType::NO ? "No":"Yes"); };
 
-  const QString tooltipText = m_item->toText() + "\nTimes resumed: " + QString::number(m_resumed) + "\nServer can resume: " + toText(m_supportsResume);
+  const QString tooltipText = m_item->toText() + "\nPriority: " + Utils::priorityName(m_item->priority) + "\nTimes resumed: " + QString::number(m_resumed) + "\nServer can resume: " + toText(m_supportsResume)
+                              + "\nStalls: " + QString::number(m_stalls)
+                              + "\nWasted: " + QLocale().formattedDataSize(m_wastedBytes)
+                              + (m_fullRestarts > 0 ? "\nRestarts from the beginning: " + QString::number(m_fullRestarts) : QString())
+                              + (m_hashFailures > 0 ? "\nHash mismatches: " + QString::number(m_hashFailures) : QString())
+                              + (m_accounting.total().cpuMsec > 0 ? "\nProcesses: " + m_accounting.total().toText() : QString())
+                              + (m_extractor ? "\nExtracted: " + QLocale().formattedDataSize(m_extractor->extractedBytes()) : QString())
+                              + (m_background ? QString("\nBackground rate: %1/s (queuing delay %2 ms)").arg(QLocale().formattedDataSize(m_background->rate())).arg(m_background->queuingDelay()) : QString());
   setToolTip(tooltipText);
 }
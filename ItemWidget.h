@@ -23,14 +23,28 @@
 // Project
 #include <Utils.h>
 #include <ConsoleOutputDialog.h>
+#include <FlightRecorder.h>
+#include <ConnectionLimiter.h>
+#include <ProcessAccounting.h>
+#include <OutputWriter.h>
 #include "ui_ItemWidget.h"
 
 // Qt
 #include <QWidget>
 #include <QProcess>
 #include <QTimer>
+#include <QPointer>
+#include <QElapsedTimer>
+
+// C++
+#include <deque>
+#include <memory>
 
 class AddItemDialog;
+class ProxyPool;
+class SegmentedDownload;
+class BackgroundRate;
+class ArchiveExtractor;
 
 /**
  * @brief Widget for the list widget representing an item. 
@@ -42,15 +56,18 @@ class ItemWidget
     Q_OBJECT
   public:
     static int FONT_ID; // id of font loaded from resource file.
+    static const QString DRAG_MIME_TYPE; // mime type of the dragged items data.
 
     /**
      * @brief ItemWidget class constructor. 
      * @brief config Application configuration struct reference. 
      * @param item Item information struct reference.
+     * @param pool Proxy pool for the items that use it or nullptr.
+     * @param limiter Connections limiter or nullptr for no limits.
      * @param parent Raw pointer of thw widget parent of this one. 
      * @param f Window flags.
      */
-    ItemWidget(const Utils::Configuration &m_config, Utils::ItemInformation *item, QWidget* parent = nullptr, Qt::WindowFlags f = Qt::WindowFlags());
+    ItemWidget(const Utils::Configuration &m_config, Utils::ItemInformation *item, ProxyPool *pool = nullptr, ConnectionLimiter *limiter = nullptr, QWidget* parent = nullptr, Qt::WindowFlags f = Qt::WindowFlags());
 
     /** 
      * @brief ItemWidget class virtual destructor. 
@@ -88,24 +105,145 @@ class ItemWidget
     unsigned int progress() const
     { return m_progressVal; }
 
+    /**
+     * @brief Returns the name of the current status.
+     */
+    QString statusName() const;
+
+    /**
+     * @brief Returns true if the download can be paused without losing the data received.
+     */
+    bool canResume() const
+    { return m_supportsResume != ResumeType::NO; }
+
+    /**
+     * @brief Sets the priority of the item.
+     * @param priority Priority value.
+     */
+    void setPriority(const Utils::Priority priority);
+
+    /**
+     * @brief Returns the number of transfers started.
+     */
+    int attempts() const
+    { return m_attempts; }
+
+    /**
+     * @brief Returns the number of consecutive failed transfers.
+     */
+    unsigned int failures() const
+    { return m_failures; }
+
+    /**
+     * @brief Returns the bytes discarded because of invalid resumes or restarts.
+     */
+    qint64 wastedBytes() const
+    { return m_wastedBytes; }
+
+    /**
+     * @brief Returns the current speed of the download in bytes per second, 0 if not running.
+     */
+    qint64 speed() const;
+
+    /**
+     * @brief Returns true if the item is downloaded by ranges.
+     */
+    bool isSegmented() const
+    { return m_ranges != nullptr; }
+
+    /**
+     * @brief Sets the maximum number of ranges downloaded at the same time, if downloaded by ranges.
+     * @param segments Number of ranges.
+     */
+    void setMaxSegments(const unsigned int segments);
+
+    /**
+     * @brief Enables or disables the background rate control of the item.
+     * @param background True to download in the background.
+     */
+    void setBackground(const bool background);
+
+    /**
+     * @brief Enables or disables the extraction of the archive while it's downloaded.
+     * @param extract True to extract the archive.
+     */
+    void setExtract(const bool extract);
+
+    /**
+     * @brief Returns the extractor of the archive, once finished it's extracting the rest of the file
+     * and is deleted when done. nullptr if not extracting.
+     */
+    ArchiveExtractor *extractor() const;
+
+    /**
+     * @brief Returns the rate limit of the transfers in bytes per second, the lowest of the
+     * schedule and the background rate control, 0 for no limit.
+     */
+    qint64 rateLimit() const;
+
+    /**
+     * @brief Stops the transfer and waits while the network is down, starts it again when it's up.
+     * @param offline True if the network is down.
+     */
+    void setOffline(const bool offline);
+
+    /**
+     * @brief Returns true if the item is waiting for the network.
+     */
+    bool isOffline() const
+    { return m_offline; }
+
+    /**
+     * @brief Returns the resource usage of the curl processes of the item.
+     */
+    const ProcessAccounting::Usage &usage() const
+    { return m_accounting.total(); }
+
   public slots:
     /**
      * @brief Stops the curl process.
      */
     void stopProcess();
 
+    /**
+     * @brief Pauses the download, if running.
+     */
+    void pause();
+
+    /**
+     * @brief Resumes the download, if paused.
+     */
+    void resume();
+
+    /**
+     * @brief Cancels the download without asking the user.
+     */
+    void cancel();
+
+    /**
+     * @brief Applies the current rate limit. curl can't change the limit of a running transfer,
+     * it's restarted if the change is big enough and the server can resume.
+     */
+    void updateRateLimit();
+
   signals:
     void cancelled();
     void finished();
     void progress();
+    void stalled();
+    void statusChanged();
+    void priorityChanged();
+    void failed(int code);
     
   protected:
     virtual void paintEvent(QPaintEvent *event) override;
-    virtual void mousePressEvent(QMouseEvent *) override;
+    virtual void mousePressEvent(QMouseEvent *event) override;
+    virtual void mouseMoveEvent(QMouseEvent *event) override;
+    virtual void mouseReleaseEvent(QMouseEvent *event) override;
     virtual void enterEvent(QEnterEvent *event) override;
 
   private: 
-    enum class Status: char { STARTING = 0, DOWNLOADING = 1, RETRYING = 2, ERROR_ = 3, FINISHED = 4, ABORTED = 5, PAUSED = 6 };
+    enum class Status: char { STARTING = 0, DOWNLOADING = 1, RETRYING = 2, ERROR_ = 3, FINISHED = 4, ABORTED = 5, PAUSED = 6, VERIFYING = 7, WAITING = 8 };
 
   private slots:
     /**
@@ -141,7 +279,53 @@ class ItemWidget
      */
     void startProcess();
 
+    /**
+     * @brief Checks the speed of the transfer in the stall window and restarts the process if stalled.
+     */
+    void onStallCheck();
+
+    /**
+     * @brief Continues the curl process stopped by the backpressure once the writer has drained.
+     */
+    void onOutputCheck();
+
+    /**
+     * @brief Updates the widget with the progress of the download by ranges.
+     * @param downloaded Bytes of the file downloaded.
+     * @param total Size of the file.
+     * @param speed Current speed in bytes per second.
+     */
+    void onRangesProgress(qint64 downloaded, qint64 total, qint64 speed);
+
+    /**
+     * @brief Handles the end of the download by ranges like the end of the curl process.
+     * @param code curl exit code.
+     */
+    void onRangesFinished(int code);
+
+    /**
+     * @brief Switches to a single transfer from the url when the download by ranges isn't possible.
+     */
+    void onRangesUnsupported();
+
+    /**
+     * @brief Samples the resource usage of the running curl processes.
+     */
+    void onAccountingTimer();
+
+    /**
+     * @brief Shows the result of the extraction of the archive in the console.
+     * @param success True if extracted.
+     * @param message Result text.
+     */
+    void onExtracted(bool success, const QString &message);
+
   private:
+    /**
+     * @brief Shows the dialog to modify the item and applies the changes.
+     */
+    void showModifyDialog();
+
     /**
      * @brief Connects signals to slots.
     */
@@ -179,21 +363,195 @@ class ItemWidget
      */
     void updateTooltip();
 
+    /**
+     * @brief Stores the trace of the failed attempt on disk.
+     * @param code curl exit code.
+     */
+    void persistFailureTrace(const int code);
+
+    /**
+     * @brief Classifies the error of the failed attempt and schedules the retry, if any.
+     * @param code curl exit code.
+     */
+    void scheduleRetry(const int code);
+
+    /**
+     * @brief Returns the path of the file with the response headers of the current attempt.
+     */
+    QString headersFile() const;
+
+    /**
+     * @brief Returns the path of the temporal file of the item.
+     */
+    QString temporalFile() const;
+
+    /**
+     * @brief Returns the path of the file storing the validator of the item.
+     */
+    QString validatorFile() const;
+
+    /**
+     * @brief Stores the validator of the current response if the item doesn't have one or the
+     * response has the complete file.
+     * @param headers Headers of the current response.
+     */
+    void updateValidator(const Utils::ResponseHeaders &headers);
+
+    /**
+     * @brief Updates the resume support of the server from the Accept-Ranges header.
+     * @param headers Headers of the current response.
+     */
+    void updateResumeSupport(const Utils::ResponseHeaders &headers);
+
+    /**
+     * @brief Stops retrying the download until the play button is pressed.
+     * @param reason Text explaining the failure.
+     */
+    void failPermanently(const QString &reason);
+
+    /**
+     * @brief Returns true if the server can't resume and the maximum number of restarts from the
+     * beginning has been reached.
+     */
+    bool fullRestartsExhausted() const;
+
+    /**
+     * @brief Adds the given bytes to the wasted bytes of the item and the application.
+     * @param bytes Number of bytes.
+     */
+    void addWastedBytes(const qint64 bytes);
+
+    /**
+     * @brief Continues the curl process if it was stopped by the backpressure of the writer.
+     */
+    void resumeOutput();
+
+    /**
+     * @brief Creates the download by ranges if the item has mirrors or pieces and it doesn't exist.
+     */
+    void createRanges();
+
+    /**
+     * @brief Reports the failure of the current proxy to the pool and switches to another one.
+     * Returns true if the proxy has changed.
+     */
+    bool rotateProxy();
+
+    /**
+     * @brief Reports the average speed of the finished attempt to the proxy pool.
+     */
+    void reportThroughput();
+
+    /**
+     * @brief Truncates the temporal file and restarts the download when the server rejects the resume
+     * because the file has changed or it doesn't support ranges.
+     */
+    void invalidateResume();
+
+    /**
+     * @brief Handles the rejection of the range of a resume. Returns true if the temporal file has the
+     * size of the remote file and is complete, otherwise truncates it and restarts the download.
+     * @param headers Headers of the 416 response.
+     */
+    bool checkRemoteSize(const Utils::ResponseHeaders &headers);
+
+    /**
+     * @brief Verifies the hashes of the downloaded file in a separate thread and finishes the item
+     * if they match or downloads again the parts that don't.
+     */
+    void verifyDownload();
+
+    /**
+     * @brief Ends the item as finished or aborted.
+     */
+    void endDownload();
+
+    /**
+     * @brief Starts the latency probes of the background rate control to the proxy or the host.
+     */
+    void startRateProbes();
+
+    /**
+     * @brief Starts the extraction of the temporal file if enabled and not running.
+     */
+    void startExtraction();
+
+    /**
+     * @brief Extracts the archive again from the beginning, the temporal file has been truncated.
+     */
+    void restartExtraction();
+
+    /**
+     * @brief Returns the exact number of bytes of the file received, used to measure the speed for
+     * the stall detection.
+     */
+    qint64 transferredBytes() const;
+
+    /**
+     * @brief Returns true if the curl process or the download by ranges is running.
+     */
+    bool isTransferRunning() const;
+
+    /**
+     * @brief Returns the identifier of the item in the trace events.
+     */
+    std::uint64_t traceId() const
+    { return reinterpret_cast<quintptr>(m_item); }
+    /**
+     * @brief Returns true if the given text is a line of the curl progress meter and false otherwise.
+     * @param text Text of the curl output.
+     */
+    static bool isProgressLine(const QString &text);
+
   private:
     enum class ResumeType:char { UNKNOWN = 0, YES = 1, NO = 2 };
 
     Utils::ItemInformation *m_item;       /** item information. */
     const Utils::Configuration &m_config; /** application configuration reference. */
+    ProxyPool *m_proxyPool;               /** proxy pool or nullptr. */
+    ConnectionLimiter *m_limiter;         /** connections limiter or nullptr. */
+    ConnectionLimiter::Connection m_connection; /** connection of the single transfer counted by the limiter. */
     bool m_finished;                      /** true if the item has been downloaded and false otherwise. */
     bool m_aborted;                       /** true if aborted and false otherwise. */
     bool m_paused;                        /** true if paused and false otherwise. */
+    bool m_offline;                       /** true while the network is down. */
     ResumeType m_supportsResume;          /** server supports resuming. */
     int m_resumed;                        /** number of times resumed. */
+    bool m_receivedData;                  /** true if the current attempt has received data. */
+    int m_attempts;                       /** number of curl processes started. */
+    unsigned int m_failures;              /** number of consecutive failed attempts. */
+    unsigned int m_stalls;                /** number of stalled transfers restarted. */
+    qint64 m_wastedBytes;                 /** bytes discarded because of invalid resumes or restarts from the beginning. */
+    unsigned int m_fullRestarts;          /** number of restarts from the beginning because the server can't resume. */
+    unsigned int m_hashFailures;          /** number of downloads that didn't match the hashes of the manifest. */
+    bool m_verifying;                     /** true while the hashes of the downloaded file are verified. */
+    bool m_restartRequested;              /** true if the process has been stopped to be restarted immediately. */
+    qint64 m_receivedBytes;               /** bytes received in the current attempt. */
+    qint64 m_streamedBytes;               /** bytes of the body streamed to stdout in the current attempt. */
+    qint64 m_bytesPerSecond;              /** last speed reported in bytes per second. */
+    std::deque<std::pair<qint64, qint64>> m_speedSamples; /** (elapsed msec, received bytes) samples of the stall window. */
+    QElapsedTimer m_attemptTime;          /** time since the start of the current attempt. */
+    QTimer m_stallTimer;                  /** stall detection timer. */
     QString m_remainSize;                 /** remaining file size. */
     unsigned int m_progressVal;           /** progress value in [0,100] */
+    Status m_statusValue;                 /** current status. */
     ConsoleOutputDialog m_console;        /** console text dialog. */
     QProcess m_process;                   /** curl process. */
+    std::unique_ptr<OutputWriter> m_writer; /** writer of the body streamed by the current attempt or nullptr. */
+    bool m_outputSuspended;               /** true while curl is stopped until the writer drains. */
+    QTimer m_outputTimer;                 /** checks the writer while curl is stopped. */
+    QByteArray m_inlineHash;              /** hash of the whole file computed while writing it, empty if not available. */
+    SegmentedDownload *m_ranges;          /** download by ranges from the mirrors or nullptr if not used. */
+    bool m_singleTransfer;                /** true if the current attempt downloads from the url after the ranges failed. */
+    BackgroundRate *m_background;         /** rate control of the background transfers or nullptr if not used. */
+    QPointer<ArchiveExtractor> m_extractor; /** extractor of the archive or nullptr if not extracting. */
+    qint64 m_appliedRate;                 /** rate limit of the current attempt in bytes per second, 0 for none. */
     QTimer m_timer;                       /** Retry timer. */
+    ProcessAccounting m_accounting;       /** resource usage of the curl processes. */
+    QTimer m_accountingTimer;             /** resource usage sampling timer. */
+    FlightRecorder m_recorder;            /** curl trace of the current attempt. */
+    QPoint m_dragStart;                   /** position of the mouse press. */
+    bool m_dragged;                       /** true if the widget has been dragged since the mouse press. */
 };
 
 #endif
\ No newline at end of file
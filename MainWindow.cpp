@@ -23,6 +23,10 @@
 #include <ConfigurationDialog.h>
 #include <AddItemDialog.h>
 #include <ItemWidget.h>
+#include <Tracer.h>
+#include <Metrics.h>
+#include <Manifest.h>
+#include <ProcessLimits.h>
 
 // Qt
 #include <QMessageBox>
@@ -31,6 +35,16 @@
 #include <QFile>
 #include <QDir>
 #include <QDebug>
+#include <QFileDialog>
+#include <QClipboard>
+#include <QLocalSocket>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QMimeData>
+#include <QDropEvent>
+
+// C++
+#include <algorithm>
 
 const QString CURL_LOCATION_KEY = "Curl executable location";
 const QString DOWNLOAD_FOLDER_KEY = "Download folder";
@@ -38,6 +52,115 @@ const QString WAIT_TIME_KEY = "Wait time";
 const QString TEMPORAL_EXTENSION = "Temporal extension";
 const QString GEOMETRY = "Window geometry";
 const QString STATE = "GUI State";
+const QString TRACE_FILE = "Trace file";
+const QString FAILURE_TRACE_SIZE = "Failure trace size";
+const QString FAILURE_TRACES_PER_ITEM = "Failure traces per item";
+const QString FAILURE_TRACES_FOLDER_SIZE = "Failure traces folder size";
+const QString STALL_SPEED = "Stall speed";
+const QString STALL_WINDOW = "Stall window";
+const QString STALL_GRACE_PERIOD = "Stall grace period";
+const QString NON_RESUMABLE_STALL_FACTOR = "Non-resumable stall factor";
+const QString NON_RESUMABLE_KEEPALIVE = "Non-resumable keepalive";
+const QString MAX_FULL_RESTARTS = "Maximum full restarts";
+const QString PROXY_POOL = "Proxy pool";
+const QString PROXY_PROBE_INTERVAL = "Proxy probe interval";
+const QString MAX_SEGMENTS = "Maximum segments";
+const QString MIN_SEGMENT_SIZE = "Minimum segment size";
+const QString MAX_SOURCE_ERRORS = "Maximum mirror errors";
+const QString MAX_ACTIVE_DOWNLOADS = "Maximum active downloads";
+const QString PREEMPT_LOW_PRIORITY = "Preempt low priority";
+const QString MAX_HOST_CONNECTIONS = "Maximum connections per host";
+const QString MAX_PROXY_CONNECTIONS = "Maximum connections per proxy";
+const QString ADAPTIVE_CONCURRENCY = "Adaptive concurrency";
+const QString SCHEDULE = "Schedule";
+const QString CONNECTIVITY_PROBES = "Connectivity probes";
+const QString PROCESS_NICE = "Process nice";
+const QString PROCESS_IO_CLASS = "Process I/O class";
+const QString PROCESS_CGROUP = "Process cgroup";
+const QString PROCESS_CPU_WEIGHT = "Process CPU weight";
+const QString PROCESS_IO_WEIGHT = "Process I/O weight";
+const QString PROCESS_CPU_MAX = "Process CPU maximum";
+const QString PROCESS_MEMORY_MAX = "Process memory maximum";
+const QString STREAM_OUTPUT = "Stream output";
+const QString OUTPUT_BLOCK_SIZE = "Output block size";
+const QString OUTPUT_SYNC_INTERVAL = "Output sync interval";
+const QString EXTRACTOR_LOCATION = "Extractor location";
+const QString POST_PROCESSING_GROUP = "Post-processing";
+const QString POST_PROCESSING_THREADS = "Threads";
+const QString POST_PROCESSING_TIMEOUT = "Timeout";
+
+const QString INSTANCE_SERVER = "CurlDownloader";
+const QString CONTROL_SERVER = "CurlDownloader-control";
+
+const int MAX_LIST_PAGE = 1000;
+const int TUNE_INTERVAL = 1000; // milliseconds between throughput samples of the tuner.
+const int SCHEDULE_INTERVAL = 30000; // milliseconds between checks of the schedule rules.
+const unsigned int WAVE_SIZE = 4; // items started again at the same time when the network is up.
+const int WAVE_INTERVAL = 3000; // milliseconds between waves of items started again.
+
+namespace
+{
+  /**
+   * @brief Returns the item identifiers of a control request, from 'item' or 'items'.
+   * @param request Request object.
+   */
+  QList<quint64> requestItems(const QJsonObject &request)
+  {
+    QList<quint64> ids;
+    if(request.contains("item"))
+      ids << static_cast<quint64>(request.value("item").toInteger());
+    for(const auto value: request.value("items").toArray())
+      ids << static_cast<quint64>(value.toInteger());
+
+    return ids;
+  }
+
+  /**
+   * @brief Returns the information of an item for the control API.
+   * @param item Item information.
+   * @param widget Item widget or nullptr if queued.
+   * @param details True to include all the information, false for the list fields.
+   */
+  QJsonObject itemObject(const Utils::ItemInformation *item, const ItemWidget *widget, const bool details)
+  {
+    QJsonObject object{{"item", static_cast<qint64>(item->id)},
+                       {"name", item->outputName},
+                       {"status", widget ? widget->statusName() : QString("queued")},
+                       {"progress", widget ? static_cast<int>(widget->progress()) : 0},
+                       {"priority", Utils::priorityName(item->priority)}};
+
+    if(details)
+    {
+      object.insert("url", item->url.toString());
+      object.insert("size", item->size);
+      object.insert("mirrors", item->mirrors.size());
+      object.insert("pool", item->usePool);
+      object.insert("background", item->background);
+      object.insert("extract", item->extract);
+      if(!item->postProcessing.isEmpty())
+        object.insert("postProcessing", QJsonArray::fromStringList(item->postProcessing));
+      if(!item->server.isEmpty())
+        object.insert("proxy", QString("%1:%2").arg(item->server).arg(item->port));
+      if(!item->hashes.isEmpty())
+        object.insert("hash", item->hashes.type);
+      if(widget)
+      {
+        object.insert("attempts", widget->attempts());
+        object.insert("failures", static_cast<int>(widget->failures()));
+        object.insert("wastedBytes", widget->wastedBytes());
+
+        const auto &usage = widget->usage();
+        object.insert("usage", QJsonObject{{"cpuMsec", usage.cpuMsec},
+                                           {"peakMemory", usage.peakMemory},
+                                           {"readBytes", usage.readBytes},
+                                           {"writeBytes", usage.writeBytes},
+                                           {"contextSwitches", usage.contextSwitches}});
+      }
+    }
+
+    return object;
+  }
+}
 
 //----------------------------------------------------------------------------
 MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
@@ -45,27 +168,69 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
 , m_needsExit{false}
 , m_trayIcon{new QSystemTrayIcon(QIcon(":/Downloader/download-bold.svg"), this)}
 , m_taskbarButton{this}
+, m_importQueued{0}
+, m_lastId{0}
+, m_controlServer{[this](const QJsonObject &request) { return handleControlRequest(request); }}
+, m_limiter{m_config}
+, m_startSequence{0}
+, m_tuner{m_config}
+, m_activeRule{-1}
 {
   setupUi(this);
   setMinimumWidth(600);
   connectSignals();
 
+  // this is the only instance, a stale server of a crashed one can be removed.
+  QLocalServer::removeServer(INSTANCE_SERVER);
+  if(!m_instanceServer.listen(INSTANCE_SERVER))
+    qWarning() << "Unable to listen for other instances:" << m_instanceServer.errorString();
+
+  if(!m_controlServer.listen(CONTROL_SERVER))
+    qWarning() << "Unable to start the control API:" << m_controlServer.errorString();
+
   loadSettings();
 
+  m_tuner.reset();
+  m_tuneTimer.setInterval(TUNE_INTERVAL);
+  connect(&m_tuneTimer, SIGNAL(timeout()), this, SLOT(onTuneTimer()));
+  if(m_config.adaptiveConcurrency)
+    m_tuneTimer.start();
+
+  m_schedule.setRules(m_config.schedule);
+  m_scheduleTimer.setInterval(SCHEDULE_INTERVAL);
+  connect(&m_scheduleTimer, SIGNAL(timeout()), this, SLOT(applySchedule()));
+  m_scheduleTimer.start();
+  applySchedule();
+
+  m_connectivity.setProbeHosts(m_config.connectivityProbes);
+  connect(&m_connectivity, SIGNAL(offline()), this, SLOT(onOffline()));
+  connect(&m_connectivity, SIGNAL(online()), this, SLOT(onOnline()));
+  m_waveTimer.setInterval(WAVE_INTERVAL);
+  connect(&m_waveTimer, SIGNAL(timeout()), this, SLOT(onResumeWave()));
+
+  connect(&m_postProcessor, SIGNAL(finished(const QString &, bool, const QString &)), this, SLOT(onPostProcessed(const QString &, bool, const QString &)));
+  m_postProcessor.setConfiguration(m_config);
+
   setupTrayIcon();
 
+  if(!m_connectivity.isOnline())
+    onOffline();
+
   this->actionAdd_file_to_download->setEnabled(m_config.isValid());
+  this->actionImport_manifest->setEnabled(m_config.isValid());
+  this->actionImport_list->setEnabled(m_config.isValid());
+  this->actionPaste_urls->setEnabled(m_config.isValid());
 }
 
 //----------------------------------------------------------------------------
 MainWindow::~MainWindow()
 {
-  if(!m_items.empty())
+  if(!m_items.empty() || queuedCount() > 0)
   {
     QMessageBox msgBox(this);
     msgBox.setWindowTitle("curl Downloader");
     msgBox.setStandardButtons(QMessageBox::Button::Yes|QMessageBox::Button::No);
-    msgBox.setText(QString("There are still %1 items being downloaded. Do you really want to exit?").arg(m_items.size()));
+    msgBox.setText(QString("There are still %1 items being downloaded. Do you really want to exit?").arg(m_items.size() + queuedCount()));
     if(QDialog::Rejected == msgBox.exec())
       return;    
   }
@@ -81,7 +246,15 @@ MainWindow::~MainWindow()
   m_widgets.clear();
   m_items.clear();
 
+  for(auto item: m_pending) delete item;
+  m_pending.clear();
+  m_pendingByHost.clear();
+  m_pendingById.clear();
+  m_generators.clear();
+
   saveSettings();
+
+  Tracer::stop();
 }
 
 //----------------------------------------------------------------------------
@@ -121,7 +294,19 @@ void MainWindow::addItem()
 
   auto item = dialog.getItem();
 
-  if(Utils::findItem(item->url, m_items) != m_items.cend())
+  if(dialog.isPattern())
+  {
+    // patterns are sorted by priority like the queue.
+    auto generator = std::make_unique<UrlGlob>(dialog.pattern(), *item);
+    auto it = std::find_if(m_generators.begin(), m_generators.end(), [&item](const auto &g) { return g->priority() < item->priority; });
+    m_generators.insert(it, std::move(generator));
+    delete item;
+
+    startPending();
+    return;
+  }
+
+  if(m_queued.contains(Utils::urlKey(item->url)))
   {
     QMessageBox msgBox(this);
     msgBox.setWindowTitle("Item information");
@@ -133,19 +318,1008 @@ void MainWindow::addItem()
     return;
   }
   
-  m_items.push_back(item);
+  enqueue(item, false);
+  startPending();
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::startItem(Utils::ItemInformation *item)
+{
+  // widgets are sorted by priority.
+  const auto index = priorityIndex(item->priority, nullptr);
+  m_items.insert(m_items.begin() + index, item);
+  Tracer::instant("item queued", reinterpret_cast<quintptr>(item), nullptr, 0, item->outputName);
   
-  auto itemWidget = new ItemWidget(m_config, m_items.back());
-  m_widgets.push_back(itemWidget);
+  auto itemWidget = new ItemWidget(m_config, item, &m_proxyPool, &m_limiter);
+  if(m_config.adaptiveConcurrency)
+    itemWidget->setMaxSegments(segmentsPerItem());
+  m_widgets.insert(m_widgets.begin() + index, itemWidget);
+  m_widgetsById.insert(item->id, itemWidget);
+  m_controlServer.publish(item->id, QJsonObject{{"event", "status"}, {"status", itemWidget->statusName()}});
 
   connect(itemWidget, SIGNAL(cancelled()), this, SLOT(onProcessFinished()));
   connect(itemWidget, SIGNAL(finished()), this, SLOT(onProcessFinished()));
   connect(itemWidget, SIGNAL(progress()), this, SLOT(onWidgetProgress()));
+  connect(itemWidget, SIGNAL(progress()), this, SLOT(onItemProgress()));
+  connect(itemWidget, SIGNAL(statusChanged()), this, SLOT(onItemStatusChanged()));
+  connect(itemWidget, SIGNAL(priorityChanged()), this, SLOT(onItemPriorityChanged()));
+  connect(itemWidget, SIGNAL(failed(int)), this, SLOT(onItemFailed(int)));
+
+  if(!m_connectivity.isOnline())
+    itemWidget->setOffline(true);
   
-  m_scrollLayout->insertWidget(m_scrollLayout->count()-1, itemWidget);
+  m_scrollLayout->insertWidget(index, itemWidget);
   onWidgetProgress();
 }
 
+//----------------------------------------------------------------------------
+int MainWindow::priorityIndex(const Utils::Priority priority, const ItemWidget *widget) const
+{
+  return static_cast<int>(std::count_if(m_widgets.cbegin(), m_widgets.cend(), [priority, widget](const ItemWidget *w)
+  { return w != widget && w->item()->priority >= priority; }));
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::moveWidget(ItemWidget *widget, const int index)
+{
+  const auto position = std::distance(m_widgets.begin(), std::find(m_widgets.begin(), m_widgets.end(), widget));
+  if(position == static_cast<std::ptrdiff_t>(m_widgets.size())) return;
+
+  const auto item = m_items.at(position);
+  m_items.erase(m_items.begin() + position);
+  m_widgets.erase(m_widgets.begin() + position);
+
+  m_items.insert(m_items.begin() + index, item);
+  m_widgets.insert(m_widgets.begin() + index, widget);
+
+  m_scrollLayout->removeWidget(widget);
+  m_scrollLayout->insertWidget(index, widget);
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onItemPriorityChanged()
+{
+  const auto widget = qobject_cast<ItemWidget*>(sender());
+  if(!widget) return;
+
+  const auto priority = widget->item()->priority;
+  m_controlServer.publish(widget->item()->id, QJsonObject{{"event", "priority"}, {"priority", Utils::priorityName(priority)}});
+
+  // keep the position given by the user if it is still sorted.
+  const auto position = std::distance(m_widgets.begin(), std::find(m_widgets.begin(), m_widgets.end(), widget));
+  const auto above = position > 0 ? m_widgets.at(position - 1)->item()->priority : Utils::Priority::HIGH;
+  const auto below = position + 1 < static_cast<std::ptrdiff_t>(m_widgets.size()) ? m_widgets.at(position + 1)->item()->priority : Utils::Priority::LOW;
+  if(above < priority || below > priority)
+    moveWidget(widget, priorityIndex(priority, widget));
+
+  startPending();
+}
+
+//----------------------------------------------------------------------------
+bool MainWindow::eventFilter(QObject *object, QEvent *event)
+{
+  if(object == scrollWidget)
+  {
+    switch(event->type())
+    {
+      case QEvent::DragEnter:
+      case QEvent::DragMove:
+        {
+          auto dragEvent = static_cast<QDragMoveEvent *>(event);
+          if(dragEvent->mimeData()->hasFormat(ItemWidget::DRAG_MIME_TYPE))
+          {
+            dragEvent->acceptProposedAction();
+            return true;
+          }
+        }
+        break;
+      case QEvent::Drop:
+        {
+          auto dropEvent = static_cast<QDropEvent *>(event);
+          const auto widget = widgetById(dropEvent->mimeData()->data(ItemWidget::DRAG_MIME_TYPE).toULongLong());
+          if(!widget) break;
+
+          // position among the other widgets.
+          const auto y = dropEvent->position().y();
+          const auto index = static_cast<int>(std::count_if(m_widgets.cbegin(), m_widgets.cend(), [widget, y](const ItemWidget *w)
+          { return w != widget && w->geometry().center().y() < y; }));
+
+          moveWidget(widget, index);
+
+          // the item takes the priority of its new neighbours.
+          if(index > 0)
+            widget->setPriority(m_widgets.at(index - 1)->item()->priority);
+          else if(m_widgets.size() > 1)
+            widget->setPriority(m_widgets.at(1)->item()->priority);
+
+          dropEvent->acceptProposedAction();
+          return true;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  return QMainWindow::eventFilter(object, event);
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::importManifest()
+{
+  const auto filename = QFileDialog::getOpenFileName(this, tr("Import manifest"), m_config.downloadPath,
+                                                     tr("Manifests (*.meta4 *.metalink *.json);;All files (*)"));
+  if(filename.isEmpty()) return;
+
+  std::vector<Utils::ItemInformation> items;
+  QString error;
+  if(!Manifest::load(filename, items, error))
+  {
+    QMessageBox::critical(this, tr("Import manifest"), error, QMessageBox::Button::Ok);
+    return;
+  }
+
+  int imported = 0;
+  QStringList duplicated;
+  for(const auto &item: items)
+  {
+    if(!enqueue(new Utils::ItemInformation(item), false))
+    {
+      duplicated << item.outputName;
+      continue;
+    }
+
+    ++imported;
+  }
+  startPending();
+
+  auto message = QString("Imported %1 of %2 files from the manifest.").arg(imported).arg(items.size());
+  if(!duplicated.isEmpty())
+    message += QString("\nAlready being downloaded: %1").arg(duplicated.join(", "));
+
+  Utils::AutoCloseMessageBox msgBox(this);
+  msgBox.setWindowTitle(tr("Import manifest"));
+  msgBox.setStandardButtons(QMessageBox::Button::Ok);
+  msgBox.setText(message);
+  msgBox.exec();
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::enqueueArguments(const QStringList &arguments)
+{
+  if(arguments.isEmpty()) return;
+
+  if(!m_config.isValid())
+  {
+    QMessageBox::warning(this, tr("curl Downloader"), tr("Configure the application before adding downloads."), QMessageBox::Button::Ok);
+    return;
+  }
+
+  for(const auto &argument: arguments)
+  {
+    if(QFileInfo(argument).isFile())
+    {
+      m_importFiles << argument;
+      continue;
+    }
+
+    Utils::ItemInformation item;
+    if(BulkImporter::parseLine(argument, ' ', item))
+      enqueue(new Utils::ItemInformation(item), false);
+    else
+      qWarning() << "Invalid url argument" << argument;
+  }
+
+  startPending();
+
+  if(!m_importer.isRunning() && !m_importFiles.isEmpty())
+  {
+    m_importQueued = 0;
+    m_importer.start(m_importFiles.takeFirst());
+  }
+}
+
+//----------------------------------------------------------------------------
+bool MainWindow::sendToRunningInstance(const QStringList &arguments)
+{
+  QLocalSocket socket;
+  socket.connectToServer(INSTANCE_SERVER);
+  if(!socket.waitForConnected(500)) return false;
+
+  // file names are relative to this process working directory.
+  QStringList lines;
+  for(const auto &argument: arguments)
+  {
+    const QFileInfo info(argument);
+    lines << (info.isFile() ? info.absoluteFilePath() : argument);
+  }
+
+  if(!lines.isEmpty())
+  {
+    socket.write(lines.join('\n').toUtf8());
+    socket.waitForBytesWritten(1000);
+  }
+
+  socket.disconnectFromServer();
+  if(socket.state() != QLocalSocket::UnconnectedState)
+    socket.waitForDisconnected(1000);
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onInstanceConnection()
+{
+  while(m_instanceServer.hasPendingConnections())
+  {
+    auto socket = m_instanceServer.nextPendingConnection();
+
+    auto readArguments = [this, socket]()
+    {
+      const auto arguments = QString::fromUtf8(socket->readAll()).split('\n', Qt::SkipEmptyParts);
+      socket->deleteLater();
+
+      if(m_trayIcon->isVisible())
+        onTrayActivated(QSystemTrayIcon::DoubleClick);
+      raise();
+      activateWindow();
+
+      enqueueArguments(arguments);
+    };
+
+    // the other instance disconnects after sending all the arguments.
+    if(socket->state() == QLocalSocket::UnconnectedState)
+      readArguments();
+    else
+      connect(socket, &QLocalSocket::disconnected, this, readArguments);
+  }
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::importList()
+{
+  if(m_importer.isRunning())
+  {
+    QMessageBox::information(this, tr("Import list"), tr("There is an import running."), QMessageBox::Button::Ok);
+    return;
+  }
+
+  const auto filename = QFileDialog::getOpenFileName(this, tr("Import url list"), m_config.downloadPath,
+                                                     tr("Url lists (*.txt *.csv *.lst);;All files (*)"));
+  if(filename.isEmpty()) return;
+
+  m_importQueued = 0;
+  if(!m_importer.start(filename))
+    QMessageBox::critical(this, tr("Import list"), QString("Unable to open '%1'.").arg(filename), QMessageBox::Button::Ok);
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::pasteUrls()
+{
+  const auto text = QApplication::clipboard()->text();
+  if(text.trimmed().isEmpty() || m_importer.isRunning()) return;
+
+  m_importQueued = 0;
+  m_importer.start(text.toUtf8());
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onItemsImported(const std::vector<Utils::ItemInformation> &items)
+{
+  for(const auto &item: items)
+  {
+    if(enqueue(new Utils::ItemInformation(item), true))
+      ++m_importQueued;
+  }
+
+  startPending();
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onImportFinished(qint64 lines, qint64 items)
+{
+  const auto message = QString("Read %1 lines with %2 valid urls.\nQueued %3 items, %4 were already queued or downloaded.")
+                         .arg(lines).arg(items).arg(m_importQueued).arg(items - m_importQueued);
+
+  // continue with the next list received from other instances.
+  m_importQueued = 0;
+  if(!m_importFiles.isEmpty())
+    m_importer.start(m_importFiles.takeFirst());
+
+  if(!isVisible())
+  {
+    m_trayIcon->showMessage(tr("Import finished"), message);
+    return;
+  }
+
+  Utils::AutoCloseMessageBox msgBox(this);
+  msgBox.setWindowTitle(tr("Import finished"));
+  msgBox.setStandardButtons(QMessageBox::Button::Ok);
+  msgBox.setText(message);
+  msgBox.exec();
+}
+
+//----------------------------------------------------------------------------
+bool MainWindow::enqueue(Utils::ItemInformation *item, const bool checkHistory)
+{
+  const auto key = Utils::urlKey(item->url);
+  if(m_queued.contains(key) || (checkHistory && m_history.contains(key)))
+  {
+    delete item;
+    return false;
+  }
+
+  item->id = ++m_lastId;
+  m_queued.insert(key);
+  insertPending(item, false);
+  if(m_controlServer.hasSubscribers())
+    m_controlServer.publish(item->id, QJsonObject{{"event", "queued"}, {"name", item->outputName}, {"url", item->url.toString()}});
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::startPending()
+{
+  const auto maxActive = activeLimit();
+
+  // insert all the widgets of the batch with a single layout update.
+  m_scrollArea->setUpdatesEnabled(false);
+
+  // nothing starts while the network is down or the items are started again in waves.
+  while(m_connectivity.isOnline() && !m_waveTimer.isActive())
+  {
+    // pattern items are generated only when there is a free slot or they have a higher priority.
+    while(!m_generators.empty())
+    {
+      auto &generator = m_generators.front();
+      if(!generator->hasNext())
+      {
+        const auto message = QString("Generated %1 urls from '%2'.\nQueued %3 items, %4 were already queued.")
+                               .arg(generator->count()).arg(generator->pattern()).arg(generator->count() - generator->skipped()).arg(generator->skipped());
+        m_trayIcon->showMessage(tr("Pattern finished"), message);
+
+        m_generators.pop_front();
+        continue;
+      }
+
+      if(!m_pending.empty() && m_pending.front()->priority >= generator->priority()) break;
+
+      if(!enqueue(generator->next(), false))
+        generator->skip();
+    }
+
+    const auto next = nextPending();
+    const auto hasNext = next != nullptr;
+    auto preempted = highestPreempted();
+    if(!hasNext && !preempted) break;
+
+    if(maxActive > 0 && runningCount() >= maxActive)
+    {
+      // free a slot pausing a lower priority item, if enabled.
+      if(m_config.preemptLowPriority && hasNext && preempt(next->priority)) continue;
+      break;
+    }
+
+    // preempted items go before the queued ones of the same priority.
+    if(preempted && (!hasNext || preempted->item()->priority >= next->priority))
+    {
+      m_preempted.remove(preempted->item()->id);
+      preempted->resume();
+      continue;
+    }
+
+    removePending({next});
+    m_hostStarts.insert(ConnectionLimiter::hostKey(next->url), ++m_startSequence);
+    startItem(next);
+  }
+  m_scrollArea->setUpdatesEnabled(true);
+
+  updateRateShare();
+  onWidgetProgress();
+}
+
+//----------------------------------------------------------------------------
+Utils::ItemInformation *MainWindow::nextPending()
+{
+  Utils::ItemInformation *best = nullptr;
+  quint64 bestStart = 0;
+
+  // the candidate of a host is its first item that can connect, the queues are sorted by priority.
+  // The host started longest ago wins among the candidates of the same priority.
+  const auto maxPerHost = static_cast<int>(m_config.maxConnectionsPerHost);
+  for(auto it = m_pendingByHost.cbegin(); it != m_pendingByHost.cend(); ++it)
+  {
+    if(maxPerHost > 0 && m_limiter.hostConnections(it.key()) >= maxPerHost) continue;
+
+    const auto start = m_hostStarts.value(it.key(), 0);
+    for(const auto item: it.value())
+    {
+      if(best && (item->priority < best->priority || (item->priority == best->priority && start >= bestStart))) break;
+      if(isScheduleHeld(item->priority)) break;
+      if(!m_limiter.canOpen(item->url, item)) continue;
+
+      best = item;
+      bestStart = start;
+      break;
+    }
+  }
+
+  return best;
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::insertPending(Utils::ItemInformation *item, const bool first)
+{
+  // the queues are sorted by descending priority, the position is found with a binary search.
+  auto goesBefore = [item, first](const Utils::ItemInformation *other)
+  { return other->priority > item->priority || (!first && other->priority == item->priority); };
+
+  m_pending.insert(std::partition_point(m_pending.begin(), m_pending.end(), goesBefore), item);
+
+  auto &hostQueue = m_pendingByHost[ConnectionLimiter::hostKey(item->url)];
+  hostQueue.insert(std::partition_point(hostQueue.begin(), hostQueue.end(), goesBefore), item);
+
+  m_pendingById.insert(item->id, item);
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::removePending(const QSet<Utils::ItemInformation *> &items)
+{
+  auto isRemoved = [&items](Utils::ItemInformation *item) { return items.contains(item); };
+
+  QSet<QString> hosts;
+  for(const auto item: items)
+  {
+    hosts.insert(ConnectionLimiter::hostKey(item->url));
+    m_pendingById.remove(item->id);
+  }
+
+  for(const auto &host: hosts)
+  {
+    auto &hostQueue = m_pendingByHost[host];
+    hostQueue.erase(std::remove_if(hostQueue.begin(), hostQueue.end(), isRemoved), hostQueue.end());
+    if(hostQueue.empty()) m_pendingByHost.remove(host);
+  }
+
+  m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), isRemoved), m_pending.end());
+}
+
+//----------------------------------------------------------------------------
+unsigned int MainWindow::activeLimit() const
+{
+  auto limit = m_config.maxActiveDownloads;
+  if(m_activeRule >= 0 && m_schedule.rule(m_activeRule).maxActive > 0)
+    limit = m_schedule.rule(m_activeRule).maxActive;
+
+  if(!m_config.adaptiveConcurrency) return limit;
+
+  const auto tuned = m_tuner.connections();
+  return limit > 0 ? std::min(limit, tuned) : tuned;
+}
+
+//----------------------------------------------------------------------------
+bool MainWindow::isScheduleHeld(const Utils::Priority priority) const
+{
+  return m_activeRule >= 0 && m_schedule.rule(m_activeRule).pauseNonUrgent && priority < Utils::Priority::HIGH;
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::applySchedule()
+{
+  const auto index = m_schedule.activeRule(QDateTime::currentDateTime());
+  if(index != m_activeRule)
+  {
+    m_activeRule = index;
+
+    const auto text = index >= 0 ? m_schedule.rule(index).text : QString("none");
+    Tracer::instant("schedule", 0, nullptr, 0, text);
+    Metrics::add("schedule transitions", 1);
+
+    // the items that can't resume continue, pausing them would lose the data received.
+    for(auto widget: m_widgets)
+    {
+      const auto item = widget->item();
+      if(!isScheduleHeld(item->priority) || m_preempted.contains(item->id)) continue;
+      if(widget->isPaused() || widget->isFinished() || widget->isAborted() || !widget->canResume()) continue;
+
+      m_preempted.insert(item->id);
+      widget->pause();
+      m_controlServer.publish(item->id, QJsonObject{{"event", "preempted"}, {"reason", "schedule"}});
+    }
+  }
+
+  // resumes and starts the items allowed by the new rule, in priority order.
+  startPending();
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onItemFailed(int code)
+{
+  auto widget = qobject_cast<ItemWidget *>(sender());
+  if(!widget) return;
+
+  if(!m_connectivity.isOnline())
+  {
+    widget->setOffline(true);
+    return;
+  }
+
+  if(!ConnectivityMonitor::isNetworkError(code)) return;
+
+  QString host;
+  quint16 port = 0;
+  Utils::connectionTarget(*widget->item(), host, port);
+  m_connectivity.reportFailure(host, port);
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onOffline()
+{
+  m_waveTimer.stop();
+
+  // the transfers still receiving data continue, they wait if they fail.
+  for(auto widget: m_widgets)
+  {
+    if(widget->speed() == 0) widget->setOffline(true);
+  }
+
+  m_trayIcon->showMessage(tr("Network down"), tr("The downloads will continue when the network is up."));
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onOnline()
+{
+  m_trayIcon->showMessage(tr("Network up"), tr("Continuing the downloads."));
+
+  m_waveTimer.start();
+  onResumeWave();
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onPostProcessed(const QString &name, bool success, const QString &message)
+{
+  if(!success)
+    m_trayIcon->showMessage(tr("Post-processing failed"), message, QSystemTrayIcon::MessageIcon::Warning);
+  else if(!isVisible())
+    m_trayIcon->showMessage(tr("File processed"), name);
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onResumeWave()
+{
+  // widgets are sorted by priority, the paused ones don't start and don't count for the wave.
+  unsigned int started = 0;
+  bool remaining = false;
+  for(auto widget: m_widgets)
+  {
+    if(!widget->isOffline()) continue;
+
+    const auto starts = !widget->isPaused() && !widget->isFinished() && !widget->isAborted();
+    if(starts && started >= WAVE_SIZE)
+    {
+      remaining = true;
+      continue;
+    }
+
+    widget->setOffline(false);
+    if(starts) ++started;
+  }
+
+  if(remaining) return;
+
+  m_waveTimer.stop();
+  startPending();
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::updateRateShare()
+{
+  const auto total = m_activeRule >= 0 ? static_cast<qint64>(m_schedule.rule(m_activeRule).rateLimit) * 1024 : 0;
+  const auto share = total > 0 ? std::max(static_cast<qint64>(1024), total / std::max(1u, runningCount())) : 0;
+  if(share == 0 && m_config.transferRateLimit == 0) return;
+
+  m_config.transferRateLimit = share;
+  Metrics::set("scheduled rate limit", total);
+
+  for(auto widget: m_widgets)
+    widget->updateRateLimit();
+}
+
+//----------------------------------------------------------------------------
+unsigned int MainWindow::segmentsPerItem() const
+{
+  if(!m_config.adaptiveConcurrency) return m_config.maxSegments;
+
+  // the tuned connections are shared by the running items.
+  const auto running = std::max(1u, runningCount());
+  return std::clamp(m_tuner.connections() / running, 1u, std::max(1u, m_config.maxSegments));
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onTuneTimer()
+{
+  qint64 throughput = 0;
+  bool segmented = false;
+  for(const auto widget: m_widgets)
+  {
+    throughput += widget->speed();
+    segmented |= widget->isSegmented() && !widget->isPaused() && !widget->isFinished();
+  }
+
+  // the connections are all used if items wait for a slot or the ranges could use more of them.
+  const auto limit = activeLimit();
+  const auto segments = segmentsPerItem();
+  const auto saturated = (queuedCount() > 0 && limit > 0 && runningCount() >= limit) ||
+                         (segmented && segments < m_config.maxSegments);
+
+  if(!m_tuner.addSample(throughput, saturated)) return;
+
+  const auto newSegments = segmentsPerItem();
+  for(auto widget: m_widgets)
+    widget->setMaxSegments(newSegments);
+
+  startPending();
+}
+
+//----------------------------------------------------------------------------
+unsigned int MainWindow::runningCount() const
+{
+  return static_cast<unsigned int>(m_items.size() - m_preempted.size());
+}
+
+//----------------------------------------------------------------------------
+ItemWidget *MainWindow::highestPreempted() const
+{
+  ItemWidget *result = nullptr;
+  for(const auto id: m_preempted)
+  {
+    const auto widget = widgetById(id);
+    if(!widget || isScheduleHeld(widget->item()->priority)) continue;
+    if(!result || widget->item()->priority > result->item()->priority)
+      result = widget;
+  }
+
+  return result;
+}
+
+//----------------------------------------------------------------------------
+bool MainWindow::preempt(const Utils::Priority priority)
+{
+  // widgets are sorted by priority, the last ones have the lowest.
+  for(auto it = m_widgets.rbegin(); it != m_widgets.rend(); ++it)
+  {
+    auto widget = *it;
+    const auto item = widget->item();
+    if(item->priority >= priority) break;
+
+    if(widget->isPaused() || widget->isFinished() || widget->isAborted() || !widget->canResume()) continue;
+
+    m_preempted.insert(item->id);
+    widget->pause();
+    Metrics::add("preempted items", 1);
+    m_controlServer.publish(item->id, QJsonObject{{"event", "preempted"}});
+    return true;
+  }
+
+  return false;
+}
+
+//----------------------------------------------------------------------------
+quint64 MainWindow::queuedCount() const
+{
+  quint64 count = m_pending.size();
+  for(const auto &generator: m_generators)
+    count += generator->remaining();
+
+  return count;
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onItemProgress()
+{
+  const auto widget = qobject_cast<ItemWidget*>(sender());
+  if(widget && widget->speed() > 0)
+  {
+    QString host;
+    quint16 port = 0;
+    Utils::connectionTarget(*widget->item(), host, port);
+    m_connectivity.reportProgress(host, port);
+  }
+
+  if(widget && m_controlServer.hasSubscribers())
+    m_controlServer.publishProgress(widget->item()->id, widget->progress());
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::onItemStatusChanged()
+{
+  const auto widget = qobject_cast<ItemWidget*>(sender());
+  if(!widget) return;
+
+  // resumed by the user.
+  if(!widget->isPaused())
+    m_preempted.remove(widget->item()->id);
+
+  m_controlServer.publish(widget->item()->id, QJsonObject{{"event", "status"}, {"status", widget->statusName()}});
+}
+
+//----------------------------------------------------------------------------
+ItemWidget *MainWindow::widgetById(const quint64 id) const
+{
+  return m_widgetsById.value(id, nullptr);
+}
+
+//----------------------------------------------------------------------------
+Utils::ItemInformation *MainWindow::pendingById(const quint64 id) const
+{
+  return m_pendingById.value(id, nullptr);
+}
+
+//----------------------------------------------------------------------------
+QJsonObject MainWindow::handleControlRequest(const QJsonObject &request)
+{
+  const auto command = request.value("command").toString();
+
+  if(command == "add")
+  {
+    if(!m_config.isValid())
+      return ControlServer::error("The application is not configured.");
+
+    // same syntax as the lines of the url lists.
+    QStringList lines;
+    if(request.contains("url"))
+      lines << request.value("url").toString();
+    for(const auto value: request.value("urls").toArray())
+      lines << value.toString();
+
+    auto priority = Utils::Priority::NORMAL;
+    if(request.contains("priority") && !Utils::priorityFromName(request.value("priority").toString(), priority))
+      return ControlServer::error("Invalid priority, must be 'low', 'normal' or 'high'.");
+
+    const auto checkHistory = request.value("skipDownloaded").toBool(false);
+    const auto background = request.value("background").toBool(false);
+    const auto extract = request.value("extract").toBool(false);
+    QStringList postProcessing;
+    for(const auto value: request.value("postProcessing").toArray())
+      postProcessing << value.toString();
+    QJsonArray ids, rejected;
+    for(const auto &line: lines)
+    {
+      Utils::ItemInformation item;
+      auto newItem = BulkImporter::parseLine(line, ' ', item) ? new Utils::ItemInformation(item) : nullptr;
+      if(newItem)
+      {
+        newItem->priority = priority;
+        newItem->background = background;
+        newItem->extract = extract;
+        newItem->postProcessing = postProcessing;
+      }
+      if(newItem && enqueue(newItem, checkHistory))
+        ids << static_cast<qint64>(newItem->id);
+      else
+        rejected << line;
+    }
+    startPending();
+
+    return QJsonObject{{"items", ids}, {"rejected", rejected}};
+  }
+
+  if(command == "pause" || command == "resume" || command == "cancel")
+  {
+    auto ids = requestItems(request);
+    QJsonArray done, unknown;
+    if(request.value("all").toBool(false))
+    {
+      ids.clear();
+      for(const auto item: m_items) ids << item->id;
+
+      // the whole queue is cancelled at once.
+      if(command == "cancel")
+      {
+        for(const auto item: m_pending)
+        {
+          m_queued.remove(Utils::urlKey(item->url));
+          m_controlServer.publish(item->id, QJsonObject{{"event", "done"}, {"result", "aborted"}});
+          done << static_cast<qint64>(item->id);
+          delete item;
+        }
+        m_pending.clear();
+        m_pendingByHost.clear();
+        m_pendingById.clear();
+      }
+    }
+
+    const auto removeFile = request.value("removeFile").toBool(false);
+    QSet<Utils::ItemInformation *> cancelled;
+    for(const auto id: ids)
+    {
+      auto widget = widgetById(id);
+      if(widget)
+      {
+        if(command == "pause")
+          widget->pause();
+        else if(command == "resume")
+          widget->resume();
+        else
+        {
+          m_controlCancelled.insert(id, removeFile);
+          widget->cancel();
+        }
+
+        done << static_cast<qint64>(id);
+        continue;
+      }
+
+      // queued items can only be cancelled, they aren't running.
+      const auto item = pendingById(id);
+      if(item && command == "cancel")
+      {
+        if(!cancelled.contains(item))
+        {
+          m_queued.remove(Utils::urlKey(item->url));
+          m_controlServer.publish(id, QJsonObject{{"event", "done"}, {"result", "aborted"}});
+          cancelled.insert(item);
+        }
+        done << static_cast<qint64>(id);
+        continue;
+      }
+
+      unknown << static_cast<qint64>(id);
+    }
+
+    removePending(cancelled);
+    qDeleteAll(cancelled);
+    onWidgetProgress();
+
+    return QJsonObject{{"items", done}, {"unknown", unknown}};
+  }
+
+  if(command == "reprioritize")
+  {
+    const auto ids = requestItems(request);
+    const auto first = request.value("position").toString("first") == "first";
+
+    auto priority = Utils::Priority::NORMAL;
+    const auto hasPriority = request.contains("priority");
+    if(hasPriority && !Utils::priorityFromName(request.value("priority").toString(), priority))
+      return ControlServer::error("Invalid priority, must be 'low', 'normal' or 'high'.");
+
+    // queued items move to the start or end of their priority in the order of the request.
+    std::vector<Utils::ItemInformation *> moved;
+    QSet<Utils::ItemInformation *> removed;
+    QJsonArray done, unknown;
+    for(const auto id: ids)
+    {
+      auto widget = widgetById(id);
+      if(widget)
+      {
+        if(hasPriority) widget->setPriority(priority);
+        done << static_cast<qint64>(id);
+        continue;
+      }
+
+      const auto item = pendingById(id);
+      if(!item)
+      {
+        unknown << static_cast<qint64>(id);
+        continue;
+      }
+
+      if(!removed.contains(item))
+      {
+        removed.insert(item);
+        moved.push_back(item);
+      }
+      done << static_cast<qint64>(id);
+    }
+
+    // removed before changing the priorities, the queues must stay sorted.
+    removePending(removed);
+    if(hasPriority)
+      for(const auto item: moved) item->priority = priority;
+
+    if(first)
+      std::for_each(moved.rbegin(), moved.rend(), [this](Utils::ItemInformation *item) { insertPending(item, true); });
+    else
+      std::for_each(moved.begin(), moved.end(), [this](Utils::ItemInformation *item) { insertPending(item, false); });
+
+    startPending();
+
+    return QJsonObject{{"items", done}, {"unknown", unknown}};
+  }
+
+  if(command == "list")
+  {
+    const auto offset = std::max(static_cast<qint64>(0), request.value("offset").toInteger(0));
+    const auto limit = std::clamp(request.value("limit").toInteger(100), static_cast<qint64>(1), static_cast<qint64>(MAX_LIST_PAGE));
+    const auto status = request.value("status").toString();
+
+    // active items first, then the queue.
+    QJsonArray items;
+    qint64 total = 0;
+    auto addItem = [&](const Utils::ItemInformation *item, const ItemWidget *widget)
+    {
+      if(!status.isEmpty() && status != (widget ? widget->statusName() : QString("queued"))) return;
+      if(total >= offset && total < offset + limit)
+        items << itemObject(item, widget, false);
+      ++total;
+    };
+
+    for(size_t i = 0; i < m_items.size(); ++i)
+      addItem(m_items.at(i), m_widgets.at(i));
+
+    // every queued item matches, only the ones in the page are visited.
+    if(status.isEmpty() || status == "queued")
+    {
+      const auto count = static_cast<qint64>(m_pending.size());
+      for(auto i = std::max(offset - total, static_cast<qint64>(0)); i < std::min(offset + limit - total, count); ++i)
+        items << itemObject(m_pending.at(i), nullptr, false);
+      total += count;
+    }
+
+    return QJsonObject{{"total", total}, {"offset", offset}, {"items", items}};
+  }
+
+  if(command == "get")
+  {
+    const auto id = static_cast<quint64>(request.value("item").toInteger());
+
+    const auto widget = widgetById(id);
+    if(widget)
+      return QJsonObject{{"item", itemObject(widget->item(), widget, true)}};
+
+    const auto item = pendingById(id);
+    if(item)
+      return QJsonObject{{"item", itemObject(item, nullptr, true)}};
+
+    return ControlServer::error(QString("Unknown item %1.").arg(id));
+  }
+
+  if(command == "metrics")
+  {
+    ProcessLimits::updateMetrics(m_config);
+
+    QJsonObject metrics;
+    const auto values = Metrics::snapshot();
+    for(auto it = values.cbegin(); it != values.cend(); ++it)
+      metrics.insert(it.key(), it.value());
+
+    return QJsonObject{{"active", static_cast<qint64>(m_items.size())},
+                       {"queued", static_cast<qint64>(queuedCount())},
+                       {"postProcessing", m_postProcessor.pending()},
+                       {"metrics", metrics}};
+  }
+
+  return ControlServer::error(QString("Unknown command '%1'.").arg(command));
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::loadHistory()
+{
+  m_history.clear();
+
+  QFile file(m_config.historyFile());
+  if(!file.open(QIODevice::ReadOnly|QIODevice::Text)) return;
+
+  while(!file.atEnd())
+  {
+    const auto line = QString::fromUtf8(file.readLine()).trimmed();
+    if(!line.isEmpty())
+      m_history.insert(Utils::urlKey(QUrl(line)));
+  }
+}
+
+//----------------------------------------------------------------------------
+void MainWindow::addToHistory(const QUrl &url)
+{
+  m_history.insert(Utils::urlKey(url));
+
+  QDir().mkpath(m_config.metadataFolder());
+  QFile file(m_config.historyFile());
+  if(file.open(QIODevice::WriteOnly|QIODevice::Append|QIODevice::Text))
+    file.write(url.toString(QUrl::FullyEncoded).toUtf8() + '\n');
+}
+
 //----------------------------------------------------------------------------
 void MainWindow::showConfigurationDialog()
 {
@@ -155,7 +1329,17 @@ void MainWindow::showConfigurationDialog()
   if(dialog.exec() == QDialog::Accepted)
   {
     m_config = dialog.getConfiguration();
+    m_proxyPool.setProxies(m_config.proxyPool);
+    m_connectivity.setProbeHosts(m_config.connectivityProbes);
+    m_postProcessor.setConfiguration(m_config);
+    m_schedule.setRules(m_config.schedule);
+    m_activeRule = -2; // force the transition to the current rule.
+    applySchedule();
     this->actionAdd_file_to_download->setEnabled(true);
+    this->actionImport_manifest->setEnabled(true);
+    this->actionImport_list->setEnabled(true);
+    this->actionPaste_urls->setEnabled(true);
+    loadHistory();
   }
 }
 
@@ -170,9 +1354,42 @@ void MainWindow::onProcessFinished()
     const auto item = widget->item();
     const QString title("Item information");
 
+    auto itemIt = Utils::findItem(item->url, m_items);
+    auto widgetIt = m_widgets.begin() + std::distance(m_items.cbegin(), itemIt);
+    m_widgets.erase(widgetIt);
+    m_items.erase(itemIt);
+    m_queued.remove(Utils::urlKey(item->url));
+    m_widgetsById.remove(item->id);
+    m_preempted.remove(item->id);
+    m_controlServer.publish(item->id, QJsonObject{{"event", "done"}, {"result", hasFinished ? "finished" : "aborted"}});
+    if(hasFinished) addToHistory(item->url);
+
+    // items cancelled by the control API don't ask the user.
+    const auto controlCancelled = m_controlCancelled.contains(item->id);
+    const auto removeTemporal = m_controlCancelled.take(item->id);
+    
+    // rename and remove only if QProcess no longer exists and curl has finished.
     if(hasFinished)
     {
-      if (!isVisible())
+      QDir downloadDir(m_config.downloadPath);
+      auto renamed = true;
+      if (!m_config.extension.isEmpty())
+      {
+        Tracer::ScopedSpan span("rename", reinterpret_cast<quintptr>(item));
+        renamed = QFile::rename(downloadDir.absoluteFilePath(item->outputName + m_config.extension), downloadDir.absoluteFilePath(item->outputName));
+      }
+
+      // the next downloads and the post-processing don't wait for the user.
+      if(renamed)
+        m_postProcessor.submit(*item, downloadDir.absoluteFilePath(item->outputName), widget->extractor());
+      startPending();
+
+      if(!renamed)
+      {
+        const auto message = QString("Unable to rename the file '%1' to '%2'!").arg(item->outputName + m_config.extension).arg(item->outputName);
+        QMessageBox::critical(this, "Error!", message, QMessageBox::Button::Ok);
+      }
+      else if (!isVisible())
       {
         m_trayIcon->showMessage("File downloaded!", item->outputName);
       }
@@ -185,29 +1402,15 @@ void MainWindow::onProcessFinished()
         msgBox.exec();
       }
     }
-
-    auto itemIt = Utils::findItem(item->url, m_items);
-    auto widgetIt = m_widgets.begin() + std::distance(m_items.cbegin(), itemIt);
-    m_widgets.erase(widgetIt);
-    m_items.erase(itemIt);
-    
-    // rename and remove only if QProcess no longer exists and curl has finished.
-    if(hasFinished)
-    {
-      if (!m_config.extension.isEmpty())
-      {
-        QDir downloadDir(m_config.downloadPath);
-        if (!QFile::rename(downloadDir.absoluteFilePath(item->outputName + m_config.extension), downloadDir.absoluteFilePath(item->outputName)))
-        {
-          const auto message = QString("Unable to rename the file '%1' to '%2'!").arg(item->outputName + m_config.extension).arg(item->outputName);
-          QMessageBox::critical(this, "Error!", message, QMessageBox::Button::Ok);
-        }
-      }
-    }
     else
     {
       const auto temporalFileExists = QDir{m_config.downloadPath}.exists(item->outputName + m_config.extension);
-      if(temporalFileExists)
+      if(temporalFileExists && controlCancelled)
+      {
+        if(removeTemporal)
+          QFile::remove(QDir(m_config.downloadPath).absoluteFilePath(item->outputName + m_config.extension));
+      }
+      else if(temporalFileExists)
       {
         QMessageBox msgBox(this);
         msgBox.setWindowTitle(title);
@@ -242,8 +1445,8 @@ void MainWindow::onProcessFinished()
     throw std::runtime_error("Unable to identify removeItem sender!");
   }
 
-  // update global progress.
-  onWidgetProgress();
+  // start the next queued items and update global progress.
+  startPending();
 }
 
 //----------------------------------------------------------------------------
@@ -253,6 +1456,17 @@ void MainWindow::connectSignals()
   connect(this->actionAbout,                SIGNAL(triggered(bool)), this, SLOT(showAboutDialog()));
   connect(this->actionAdd_file_to_download, SIGNAL(triggered(bool)), this, SLOT(addItem()));
   connect(this->actionApplication_settings, SIGNAL(triggered(bool)), this, SLOT(showConfigurationDialog()));
+  connect(this->actionImport_manifest,      SIGNAL(triggered(bool)), this, SLOT(importManifest()));
+  connect(this->actionImport_list,          SIGNAL(triggered(bool)), this, SLOT(importList()));
+  connect(this->actionPaste_urls,           SIGNAL(triggered(bool)), this, SLOT(pasteUrls()));
+
+  connect(&m_importer, &BulkImporter::itemsRead, this, &MainWindow::onItemsImported);
+  connect(&m_importer, &BulkImporter::finished, this, &MainWindow::onImportFinished);
+
+  connect(&m_instanceServer, SIGNAL(newConnection()), this, SLOT(onInstanceConnection()));
+
+  scrollWidget->setAcceptDrops(true);
+  scrollWidget->installEventFilter(this);
 
   connect(m_trayIcon, SIGNAL(activated(QSystemTrayIcon::ActivationReason)),
           this,       SLOT(onTrayActivated(QSystemTrayIcon::ActivationReason)));  
@@ -268,7 +1482,7 @@ void MainWindow::quitApplication()
         return;
     }
 
-    if (!m_items.empty()) {
+    if (!m_items.empty() || queuedCount() > 0) {
         QMessageBox warningMsg(this);
         s_closeWarningDialog = &warningMsg;
         warningMsg.setWindowIcon(QIcon(":/Downloader/download-bold.svg"));
@@ -326,8 +1540,66 @@ void MainWindow::loadSettings()
   auto extension = settings->value(TEMPORAL_EXTENSION).toString();
 
   Utils::Configuration config(curlLocation, downloadFolder, waitTime, extension);
+  config.traceFile = settings->value(TRACE_FILE).toString();
+  config.failureTraceSize = settings->value(FAILURE_TRACE_SIZE, config.failureTraceSize).toUInt();
+  config.failureTracesPerItem = settings->value(FAILURE_TRACES_PER_ITEM, config.failureTracesPerItem).toUInt();
+  config.failureTracesFolderSize = settings->value(FAILURE_TRACES_FOLDER_SIZE, config.failureTracesFolderSize).toUInt();
+  config.retryPolicy.load(*settings);
+  config.stallSpeed = settings->value(STALL_SPEED, config.stallSpeed).toUInt();
+  config.stallWindow = std::max(5u, settings->value(STALL_WINDOW, config.stallWindow).toUInt());
+  config.stallGracePeriod = settings->value(STALL_GRACE_PERIOD, config.stallGracePeriod).toUInt();
+  config.nonResumableStallFactor = std::max(1u, settings->value(NON_RESUMABLE_STALL_FACTOR, config.nonResumableStallFactor).toUInt());
+  config.nonResumableKeepAlive = std::max(1u, settings->value(NON_RESUMABLE_KEEPALIVE, config.nonResumableKeepAlive).toUInt());
+  config.maxFullRestarts = settings->value(MAX_FULL_RESTARTS, config.maxFullRestarts).toUInt();
+  config.proxyPool = settings->value(PROXY_POOL).toStringList();
+  config.proxyProbeInterval = settings->value(PROXY_PROBE_INTERVAL, config.proxyProbeInterval).toUInt();
+  config.maxSegments = std::max(1u, settings->value(MAX_SEGMENTS, config.maxSegments).toUInt());
+  config.minSegmentSize = std::max(64u, settings->value(MIN_SEGMENT_SIZE, config.minSegmentSize).toUInt());
+  config.maxSourceErrors = std::max(1u, settings->value(MAX_SOURCE_ERRORS, config.maxSourceErrors).toUInt());
+  config.maxActiveDownloads = settings->value(MAX_ACTIVE_DOWNLOADS, config.maxActiveDownloads).toUInt();
+  config.preemptLowPriority = settings->value(PREEMPT_LOW_PRIORITY, config.preemptLowPriority).toBool();
+  config.maxConnectionsPerHost = settings->value(MAX_HOST_CONNECTIONS, config.maxConnectionsPerHost).toUInt();
+  config.maxConnectionsPerProxy = settings->value(MAX_PROXY_CONNECTIONS, config.maxConnectionsPerProxy).toUInt();
+  config.adaptiveConcurrency = settings->value(ADAPTIVE_CONCURRENCY, config.adaptiveConcurrency).toBool();
+  config.schedule = settings->value(SCHEDULE).toStringList();
+  config.connectivityProbes = settings->value(CONNECTIVITY_PROBES).toStringList();
+  config.processNice = std::min(19u, settings->value(PROCESS_NICE, config.processNice).toUInt());
+  config.processIoClass = settings->value(PROCESS_IO_CLASS, config.processIoClass).toString();
+  config.processCgroup = settings->value(PROCESS_CGROUP, config.processCgroup).toString();
+  config.processCpuWeight = settings->value(PROCESS_CPU_WEIGHT, config.processCpuWeight).toUInt();
+  config.processIoWeight = settings->value(PROCESS_IO_WEIGHT, config.processIoWeight).toUInt();
+  config.processCpuMax = settings->value(PROCESS_CPU_MAX, config.processCpuMax).toUInt();
+  config.processMemoryMax = settings->value(PROCESS_MEMORY_MAX, config.processMemoryMax).toUInt();
+  config.streamOutput = settings->value(STREAM_OUTPUT, config.streamOutput).toBool();
+  config.outputBlockSize = std::max(4u, settings->value(OUTPUT_BLOCK_SIZE, config.outputBlockSize).toUInt() / 4 * 4);
+  config.outputSyncInterval = settings->value(OUTPUT_SYNC_INTERVAL, config.outputSyncInterval).toUInt();
+  config.extractorPath = settings->value(EXTRACTOR_LOCATION, config.extractorPath).toString();
+
+  // the other keys of the group are name patterns with their list of stages.
+  settings->beginGroup(POST_PROCESSING_GROUP);
+  config.postProcessingThreads = std::max(1u, settings->value(POST_PROCESSING_THREADS, config.postProcessingThreads).toUInt());
+  config.postProcessingTimeout = settings->value(POST_PROCESSING_TIMEOUT, config.postProcessingTimeout).toUInt();
+  for(const auto &key: settings->childKeys())
+  {
+    if(key != POST_PROCESSING_THREADS && key != POST_PROCESSING_TIMEOUT)
+      config.postProcessing.insert(key, settings->value(key).toStringList());
+  }
+  settings->endGroup();
   m_config = config;
 
+  if(!m_config.traceFile.isEmpty() && !Tracer::start(m_config.traceFile))
+    qWarning() << "Unable to open trace file" << m_config.traceFile;
+
+  QString limitsError;
+  if(!ProcessLimits::setup(m_config, limitsError))
+    qWarning() << "Unable to apply the limits of the curl processes:" << limitsError;
+
+  m_proxyPool.setProbeInterval(m_config.proxyProbeInterval);
+  m_proxyPool.setProxies(m_config.proxyPool);
+
+  if(m_config.isValid())
+    loadHistory();
+
   if(settings->contains(GEOMETRY))
   {
     auto geometry = settings->value(GEOMETRY).toByteArray();
@@ -353,6 +1625,46 @@ void MainWindow::saveSettings()
   settings->setValue(DOWNLOAD_FOLDER_KEY, m_config.downloadPath);
   settings->setValue(WAIT_TIME_KEY, m_config.waitSeconds);
   settings->setValue(TEMPORAL_EXTENSION, m_config.extension);
+  settings->setValue(TRACE_FILE, m_config.traceFile);
+  settings->setValue(FAILURE_TRACE_SIZE, m_config.failureTraceSize);
+  settings->setValue(FAILURE_TRACES_PER_ITEM, m_config.failureTracesPerItem);
+  settings->setValue(FAILURE_TRACES_FOLDER_SIZE, m_config.failureTracesFolderSize);
+  settings->setValue(STALL_SPEED, m_config.stallSpeed);
+  settings->setValue(STALL_WINDOW, m_config.stallWindow);
+  settings->setValue(STALL_GRACE_PERIOD, m_config.stallGracePeriod);
+  settings->setValue(NON_RESUMABLE_STALL_FACTOR, m_config.nonResumableStallFactor);
+  settings->setValue(NON_RESUMABLE_KEEPALIVE, m_config.nonResumableKeepAlive);
+  settings->setValue(MAX_FULL_RESTARTS, m_config.maxFullRestarts);
+  settings->setValue(PROXY_POOL, m_config.proxyPool);
+  settings->setValue(PROXY_PROBE_INTERVAL, m_config.proxyProbeInterval);
+  settings->setValue(MAX_SEGMENTS, m_config.maxSegments);
+  settings->setValue(MIN_SEGMENT_SIZE, m_config.minSegmentSize);
+  settings->setValue(MAX_SOURCE_ERRORS, m_config.maxSourceErrors);
+  settings->setValue(MAX_ACTIVE_DOWNLOADS, m_config.maxActiveDownloads);
+  settings->setValue(PREEMPT_LOW_PRIORITY, m_config.preemptLowPriority);
+  settings->setValue(MAX_HOST_CONNECTIONS, m_config.maxConnectionsPerHost);
+  settings->setValue(MAX_PROXY_CONNECTIONS, m_config.maxConnectionsPerProxy);
+  settings->setValue(ADAPTIVE_CONCURRENCY, m_config.adaptiveConcurrency);
+  settings->setValue(SCHEDULE, m_config.schedule);
+  settings->setValue(CONNECTIVITY_PROBES, m_config.connectivityProbes);
+  settings->setValue(PROCESS_NICE, m_config.processNice);
+  settings->setValue(PROCESS_IO_CLASS, m_config.processIoClass);
+  settings->setValue(PROCESS_CGROUP, m_config.processCgroup);
+  settings->setValue(PROCESS_CPU_WEIGHT, m_config.processCpuWeight);
+  settings->setValue(PROCESS_IO_WEIGHT, m_config.processIoWeight);
+  settings->setValue(PROCESS_CPU_MAX, m_config.processCpuMax);
+  settings->setValue(PROCESS_MEMORY_MAX, m_config.processMemoryMax);
+  settings->setValue(STREAM_OUTPUT, m_config.streamOutput);
+  settings->setValue(OUTPUT_BLOCK_SIZE, m_config.outputBlockSize);
+  settings->setValue(OUTPUT_SYNC_INTERVAL, m_config.outputSyncInterval);
+  settings->setValue(EXTRACTOR_LOCATION, m_config.extractorPath);
+  settings->beginGroup(POST_PROCESSING_GROUP);
+  settings->remove("");
+  settings->setValue(POST_PROCESSING_THREADS, m_config.postProcessingThreads);
+  settings->setValue(POST_PROCESSING_TIMEOUT, m_config.postProcessingTimeout);
+  for(auto it = m_config.postProcessing.cbegin(); it != m_config.postProcessing.cend(); ++it)
+    settings->setValue(it.key(), it.value());
+  settings->endGroup();
   settings->setValue(GEOMETRY, saveGeometry());
   settings->setValue(STATE, saveState());
   settings->sync();
@@ -414,6 +1726,14 @@ void MainWindow::onWidgetProgress()
   else
     m_trayIcon->setToolTip(tr("No downloads."));
 
+  const auto queued = queuedCount();
+  if(queued > 0)
+    m_trayIcon->setToolTip(m_trayIcon->toolTip() + QString("\nQueued: %1").arg(queued));
+
+  const auto wasted = Metrics::value("wasted bytes");
+  if(wasted > 0)
+    m_trayIcon->setToolTip(m_trayIcon->toolTip() + QString("\nWasted: %1").arg(QLocale().formattedDataSize(wasted)));
+
   const auto state = progressValue == 0 ? QTaskBarButton::State::Invisible : QTaskBarButton::State::Normal;
   m_taskbarButton.setState(state);
   m_taskbarButton.setValue(static_cast<int>(progressValue));
@@ -23,11 +23,28 @@
 // Process
 #include "ui_MainWindow.h"
 #include <Utils.h>
+#include <ProxyPool.h>
+#include <BulkImporter.h>
+#include <UrlGlob.h>
+#include <ControlServer.h>
+#include <ConnectionLimiter.h>
+#include <ConcurrencyTuner.h>
+#include <Schedule.h>
+#include <ConnectivityMonitor.h>
+#include <PostProcessor.h>
 #include <external/QTaskBarButton.h>
 
 // Qt
 #include <QMainWindow>
 #include <QSystemTrayIcon>
+#include <QSet>
+#include <QHash>
+#include <QLocalServer>
+#include <QTimer>
+
+// C++
+#include <deque>
+#include <memory>
 
 class ItemWidget;
 class AboutDialog;
@@ -54,9 +71,23 @@ class MainWindow
      */
     virtual ~MainWindow();
 
+    /**
+     * @brief Queues the urls and list files given in the command line.
+     * @param arguments Urls or list file names.
+     */
+    void enqueueArguments(const QStringList &arguments);
+
+    /**
+     * @brief Sends the urls and list files to the running instance of the application. Returns
+     * false if there is no instance listening.
+     * @param arguments Urls or list file names, empty to just show the running instance.
+     */
+    static bool sendToRunningInstance(const QStringList &arguments);
+
   protected: 
     virtual void closeEvent(QCloseEvent *e) override;
     virtual void showEvent(QShowEvent *e) override;
+    virtual bool eventFilter(QObject *object, QEvent *event) override;
 
   private slots:
     /** 
@@ -74,6 +105,39 @@ class MainWindow
      */
     void addItem();
 
+    /**
+     * @brief Imports the items of a Metalink or JSON manifest.
+     */
+    void importManifest();
+
+    /**
+     * @brief Imports the urls of a text or CSV list file.
+     */
+    void importList();
+
+    /**
+     * @brief Imports the urls in the clipboard.
+     */
+    void pasteUrls();
+
+    /**
+     * @brief Queues a chunk of items read by the importer.
+     * @param items Items read.
+     */
+    void onItemsImported(const std::vector<Utils::ItemInformation> &items);
+
+    /**
+     * @brief Shows the result of the import.
+     * @param lines Number of lines read.
+     * @param items Number of valid items.
+     */
+    void onImportFinished(qint64 lines, qint64 items);
+
+    /**
+     * @brief Reads the arguments sent by another instance of the application.
+     */
+    void onInstanceConnection();
+
     /**
      * @brief Shows the configuration dialog and stores the changes, if any.
      */
@@ -95,6 +159,62 @@ class MainWindow
      */
     void onWidgetProgress();
 
+    /**
+     * @brief Sends the progress of the sender item to the subscribers of the control API.
+     */
+    void onItemProgress();
+
+    /**
+     * @brief Sends the status of the sender item to the subscribers of the control API.
+     */
+    void onItemStatusChanged();
+
+    /**
+     * @brief Moves the widget of the sender item to keep the list sorted by priority.
+     */
+    void onItemPriorityChanged();
+
+    /**
+     * @brief Measures the aggregate throughput for the concurrency tuner and applies its changes.
+     */
+    void onTuneTimer();
+
+    /**
+     * @brief Applies the schedule rule of the current time. Pauses the items without high priority
+     * when a rule that pauses them starts.
+     */
+    void applySchedule();
+
+    /**
+     * @brief Reports the network errors of the sender item to the connectivity monitor.
+     * @param code curl exit code.
+     */
+    void onItemFailed(int code);
+
+    /**
+     * @brief Stops all the transfers while the network is down.
+     */
+    void onOffline();
+
+    /**
+     * @brief Starts again the transfers stopped by the outage in waves.
+     */
+    void onOnline();
+
+    /**
+     * @brief Starts again the next items stopped by the outage, in priority order. Starts the
+     * queued items once all of them have been started.
+     */
+    void onResumeWave();
+
+    /**
+     * @brief Notifies the end of the post-processing of a file.
+     * @param name Name of the file.
+     * @param success True if all the stages succeeded.
+     * @param message Result text.
+     */
+    void onPostProcessed(const QString &name, bool success, const QString &message);
+
   private:
     /**
      * @brief Connects the signals to the slots. 
@@ -116,6 +236,135 @@ class MainWindow
      */
     void setupTrayIcon();    
 
+    /**
+     * @brief Creates the widget of the item and starts the download. Takes ownership of the item.
+     * @param item Item information.
+     */
+    void startItem(Utils::ItemInformation *item);
+
+    /**
+     * @brief Adds the item to the queue unless its url is already queued or downloading, or was
+     * downloaded before. Takes ownership of the item, deleting it if not queued.
+     * Returns true if queued.
+     * @param item Item information.
+     * @param checkHistory True to reject the urls already downloaded.
+     */
+    bool enqueue(Utils::ItemInformation *item, const bool checkHistory);
+
+    /**
+     * @brief Starts the queued items and resumes the preempted ones, higher priority first, while
+     * there are free download slots. Pauses lower priority items to free slots, if enabled.
+     */
+    void startPending();
+
+    /**
+     * @brief Returns the next queued item to start: the one with the highest priority whose host
+     * and proxy have free connections, taking the hosts in turns. Returns nullptr if none.
+     */
+    Utils::ItemInformation *nextPending();
+
+    /**
+     * @brief Inserts the item in the queue, sorted by priority.
+     * @param item Item information.
+     * @param first True to insert before the items of the same priority, false to insert after them.
+     */
+    void insertPending(Utils::ItemInformation *item, const bool first);
+
+    /**
+     * @brief Removes the items from the queue and from the queues of their hosts in one pass.
+     * @param items Queued items.
+     */
+    void removePending(const QSet<Utils::ItemInformation *> &items);
+
+    /**
+     * @brief Returns the maximum number of items downloading at the same time, configured or tuned.
+     * 0 for no limit.
+     */
+    unsigned int activeLimit() const;
+
+    /**
+     * @brief Returns the maximum number of ranges of each item downloaded by ranges, configured or
+     * tuned.
+     */
+    unsigned int segmentsPerItem() const;
+
+    /**
+     * @brief Returns true if the current schedule rule pauses the items of the given priority.
+     * @param priority Priority value.
+     */
+    bool isScheduleHeld(const Utils::Priority priority) const;
+
+    /**
+     * @brief Shares the rate limit of the schedule among the running items and applies it.
+     */
+    void updateRateShare();
+
+    /**
+     * @brief Returns the number of active items not paused to free their slot.
+     */
+    unsigned int runningCount() const;
+
+    /**
+     * @brief Returns the widget of the preempted item with the highest priority or nullptr if none.
+     */
+    ItemWidget *highestPreempted() const;
+
+    /**
+     * @brief Pauses the resumable running item with the lowest priority, if lower than the given one.
+     * Returns true if an item has been paused.
+     * @param priority Priority of the item that needs the slot.
+     */
+    bool preempt(const Utils::Priority priority);
+
+    /**
+     * @brief Returns the position of a new widget with the given priority in the sorted list.
+     * @param priority Priority value.
+     * @param widget Widget to ignore or nullptr.
+     */
+    int priorityIndex(const Utils::Priority priority, const ItemWidget *widget) const;
+
+    /**
+     * @brief Moves the widget to the given position of the list.
+     * @param widget Item widget.
+     * @param index Position among the other widgets.
+     */
+    void moveWidget(ItemWidget *widget, const int index);
+
+    /**
+     * @brief Returns the number of items waiting to start, including the ones of the patterns
+     * not generated yet.
+     */
+    quint64 queuedCount() const;
+
+    /**
+     * @brief Loads the urls of the downloaded items.
+     */
+    void loadHistory();
+
+    /**
+     * @brief Adds the url to the downloaded items.
+     * @param url Url of the downloaded item.
+     */
+    void addToHistory(const QUrl &url);
+
+    /**
+     * @brief Executes a request of the control API and returns the response.
+     * @param request Request object.
+     */
+    QJsonObject handleControlRequest(const QJsonObject &request);
+
+    /**
+     * @brief Returns the widget of the active item with the given identifier or nullptr.
+     * @param id Item identifier.
+     */
+    ItemWidget *widgetById(const quint64 id) const;
+
+    /**
+     * @brief Returns the queued item with the given identifier or nullptr if not queued.
+     * @param id Item identifier.
+     */
+    Utils::ItemInformation *pendingById(const quint64 id) const;
+
   private:
     Utils::Configuration m_config;                 /** application configuration. */
     std::vector<Utils::ItemInformation *> m_items; /** list of items being downloaded. */
@@ -123,6 +372,33 @@ class MainWindow
     bool m_needsExit;                              /** true if the application has to quit and false to minimize to tray. */
     QSystemTrayIcon *m_trayIcon;                   /** tray icon. */
     QTaskBarButton m_taskbarButton;                /** taskbar progress button. */
+    ProxyPool m_proxyPool;                         /** proxies for the items that use the pool. */
+    std::deque<Utils::ItemInformation *> m_pending; /** items waiting for a free download slot. */
+    QHash<QString, std::deque<Utils::ItemInformation *>> m_pendingByHost; /** items waiting of each host, sorted by priority. */
+    QHash<quint64, Utils::ItemInformation *> m_pendingById; /** items waiting by identifier. */
+    std::deque<std::unique_ptr<UrlGlob>> m_generators; /** url patterns with items not generated yet. */
+    QSet<quint64> m_queued;                        /** keys of the urls downloading or waiting. */
+    QSet<quint64> m_history;                       /** keys of the urls already downloaded. */
+    BulkImporter m_importer;                       /** url lists importer. */
+    qint64 m_importQueued;                         /** items queued by the current import. */
+    QStringList m_importFiles;                     /** list files waiting for the importer. */
+    QLocalServer m_instanceServer;                 /** receives the arguments of other instances. */
+    quint64 m_lastId;                              /** last item identifier assigned. */
+    QHash<quint64, ItemWidget *> m_widgetsById;    /** widgets of the active items by item identifier. */
+    QHash<quint64, bool> m_controlCancelled;       /** items cancelled by the control API and if their temporal file must be removed. */
+    ControlServer m_controlServer;                 /** local control API. */
+    QSet<quint64> m_preempted;                     /** items paused to start higher priority ones. */
+    ConnectionLimiter m_limiter;                   /** connections per host and proxy limits. */
+    QHash<QString, quint64> m_hostStarts;          /** start sequence of the last item started of each host. */
+    quint64 m_startSequence;                       /** number of items started. */
+    ConcurrencyTuner m_tuner;                      /** connections tuner by throughput. */
+    QTimer m_tuneTimer;                            /** throughput sampling timer of the tuner. */
+    Schedule m_schedule;                           /** rate limit and active downloads rules. */
+    QTimer m_scheduleTimer;                        /** schedule rules check timer. */
+    int m_activeRule;                              /** index of the schedule rule applied, -1 if none. */
+    ConnectivityMonitor m_connectivity;            /** network outages detection. */
+    QTimer m_waveTimer;                            /** timer of the waves of items started after an outage. */
+    PostProcessor m_postProcessor;                 /** post-processing of the downloaded files. */
 };
 
 #endif
\ No newline at end of file
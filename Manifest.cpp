@@ -0,0 +1,246 @@
+/*
+ File: Manifest.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Manifest.h>
+#include <Checksums.h>
+
+// Qt
+#include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// C++
+#include <algorithm>
+
+namespace
+{
+  /**
+   * @brief Returns true if curl can download the url.
+   * @param url Url.
+   */
+  bool isDownloadable(const QUrl &url)
+  {
+    const auto scheme = url.scheme().toLower();
+    return url.isValid() && (scheme == "http" || scheme == "https" || scheme == "ftp" || scheme == "ftps");
+  }
+
+  /**
+   * @brief Completes the item from its urls ordered by priority and checks the hashes. Returns false
+   * if the item has no usable url.
+   * @param item Item information.
+   * @param urls (priority, url) pairs, lower priority values first.
+   */
+  bool finishItem(Utils::ItemInformation &item, std::vector<std::pair<int, QUrl>> &urls)
+  {
+    std::stable_sort(urls.begin(), urls.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    for(const auto &url: urls)
+    {
+      if(!isDownloadable(url.second)) continue;
+
+      if(item.url.isEmpty())
+        item.url = url.second;
+      else if(url.second != item.url && !item.mirrors.contains(url.second))
+        item.mirrors << url.second;
+    }
+
+    if(item.url.isEmpty()) return false;
+
+    item.outputName = QFileInfo(item.outputName).fileName();
+    if(item.outputName.isEmpty())
+      item.outputName = item.url.fileName();
+
+    if(Checksums::strength(item.hashes.type) == -1)
+    {
+      item.hashes.type.clear();
+      item.hashes.hash.clear();
+    }
+
+    // pieces must cover the whole file to be usable.
+    const auto pieceLength = item.hashes.pieceLength;
+    const auto expectedPieces = (item.size > 0 && pieceLength > 0) ? (item.size + pieceLength - 1) / pieceLength : -1;
+    if(Checksums::strength(item.hashes.pieceType) == -1 || expectedPieces != item.hashes.pieces.size())
+    {
+      item.hashes.pieceType.clear();
+      item.hashes.pieceLength = 0;
+      item.hashes.pieces.clear();
+    }
+
+    item.server.clear();
+    item.port = 0;
+    item.protocol = Utils::Protocol::NONE;
+
+    return true;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool Manifest::load(const QString &filename, std::vector<Utils::ItemInformation> &items, QString &error)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    error = QString("Unable to open '%1': %2").arg(filename).arg(file.errorString());
+    return false;
+  }
+
+  const auto data = file.readAll();
+  const auto suffix = QFileInfo(filename).suffix().toLower();
+  if(suffix == "meta4" || suffix == "metalink" || data.trimmed().startsWith('<'))
+    return parseMetalink(data, items, error);
+
+  return parseJson(data, items, error);
+}
+
+//----------------------------------------------------------------------------
+bool Manifest::parseMetalink(const QByteArray &data, std::vector<Utils::ItemInformation> &items, QString &error)
+{
+  QXmlStreamReader reader(data);
+
+  Utils::ItemInformation item;
+  std::vector<std::pair<int, QUrl>> urls;
+  bool inFile = false;
+  bool inPieces = false;
+
+  while(!reader.atEnd())
+  {
+    reader.readNext();
+
+    if(reader.isStartElement())
+    {
+      const auto name = reader.name();
+      const auto attributes = reader.attributes();
+
+      if(name == QLatin1String("file"))
+      {
+        item = Utils::ItemInformation();
+        item.outputName = attributes.value("name").toString();
+        urls.clear();
+        inFile = true;
+      }
+      else if(!inFile)
+      {
+        continue;
+      }
+      else if(name == QLatin1String("size"))
+      {
+        item.size = reader.readElementText().trimmed().toLongLong();
+      }
+      else if(name == QLatin1String("pieces"))
+      {
+        inPieces = true;
+        item.hashes.pieceType = attributes.value("type").toString();
+        item.hashes.pieceLength = attributes.value("length").toLongLong();
+        item.hashes.pieces.clear();
+      }
+      else if(name == QLatin1String("hash"))
+      {
+        const auto type = attributes.value("type").toString();
+        const auto value = QByteArray::fromHex(reader.readElementText().trimmed().toLatin1());
+
+        if(inPieces)
+          item.hashes.pieces << value;
+        else if(Checksums::strength(type) > Checksums::strength(item.hashes.type))
+        {
+          item.hashes.type = type;
+          item.hashes.hash = value;
+        }
+      }
+      else if(name == QLatin1String("url"))
+      {
+        // version 4 'priority' (1 is the highest), version 3 'preference' (100 is the highest).
+        int priority = 999999;
+        if(attributes.hasAttribute("priority"))
+          priority = attributes.value("priority").toInt();
+        else if(attributes.hasAttribute("preference"))
+          priority = 101 - attributes.value("preference").toInt();
+
+        urls.emplace_back(priority, QUrl(reader.readElementText().trimmed()));
+      }
+    }
+    else if(reader.isEndElement())
+    {
+      if(reader.name() == QLatin1String("pieces"))
+        inPieces = false;
+      else if(reader.name() == QLatin1String("file") && inFile)
+      {
+        inFile = false;
+        if(finishItem(item, urls))
+          items.push_back(item);
+      }
+    }
+  }
+
+  if(reader.hasError())
+  {
+    error = QString("Invalid Metalink at line %1: %2").arg(reader.lineNumber()).arg(reader.errorString());
+    return false;
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool Manifest::parseJson(const QByteArray &data, std::vector<Utils::ItemInformation> &items, QString &error)
+{
+  QJsonParseError parseError;
+  const auto document = QJsonDocument::fromJson(data, &parseError);
+  if(document.isNull())
+  {
+    error = QString("Invalid JSON at offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+    return false;
+  }
+
+  const auto files = document.isArray() ? document.array() : document.object().value("files").toArray();
+  for(const auto value: files)
+  {
+    const auto object = value.toObject();
+
+    Utils::ItemInformation item;
+    item.outputName = object.value("name").toString();
+    item.size = object.value("size").toInteger();
+
+    std::vector<std::pair<int, QUrl>> urls;
+    if(object.contains("url"))
+      urls.emplace_back(0, QUrl(object.value("url").toString()));
+    for(const auto url: object.value("urls").toArray())
+      urls.emplace_back(0, QUrl(url.toString()));
+    for(const auto url: object.value("mirrors").toArray())
+      urls.emplace_back(1, QUrl(url.toString()));
+
+    const auto hash = object.value("hash").toObject();
+    item.hashes.type = hash.value("type").toString();
+    item.hashes.hash = QByteArray::fromHex(hash.value("value").toString().toLatin1());
+
+    const auto pieces = object.value("pieces").toObject();
+    item.hashes.pieceType = pieces.value("type").toString();
+    item.hashes.pieceLength = pieces.value("length").toInteger();
+    for(const auto piece: pieces.value("hashes").toArray())
+      item.hashes.pieces << QByteArray::fromHex(piece.toString().toLatin1());
+
+    if(finishItem(item, urls))
+      items.push_back(item);
+  }
+
+  return true;
+}
@@ -0,0 +1,63 @@
+/*
+ File: Manifest.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MANIFEST_H_
+#define _MANIFEST_H_
+
+// Project
+#include <Utils.h>
+
+// C++
+#include <vector>
+
+/**
+ * @brief Import of release manifests: Metalink (RFC 5854 and version 3) and JSON lists with
+ * the same information.
+ */
+namespace Manifest
+{
+  /**
+   * @brief Reads the files of the manifest as items, with their mirrors, size and hashes.
+   * Returns false on error.
+   * @param filename Manifest file, Metalink if the extension is .meta4 or .metalink, JSON otherwise.
+   * @param items Items of the manifest.
+   * @param error Error text on failure.
+   */
+  bool load(const QString &filename, std::vector<Utils::ItemInformation> &items, QString &error);
+
+  /**
+   * @brief Reads a Metalink document. Returns false on error.
+   * @param data Document contents.
+   * @param items Items of the manifest.
+   * @param error Error text on failure.
+   */
+  bool parseMetalink(const QByteArray &data, std::vector<Utils::ItemInformation> &items, QString &error);
+
+  /**
+   * @brief Reads a JSON manifest, an array of files or an object with a 'files' array. Each file
+   * has 'name', 'url' or 'urls', 'mirrors', 'size', 'hash' {'type', 'value'} and 'pieces'
+   * {'type', 'length', 'hashes'}, all optional but the url. Returns false on error.
+   * @param data Document contents.
+   * @param items Items of the manifest.
+   * @param error Error text on failure.
+   */
+  bool parseJson(const QByteArray &data, std::vector<Utils::ItemInformation> &items, QString &error);
+}
+
+#endif
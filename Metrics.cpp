@@ -0,0 +1,59 @@
+/*
+ File: Metrics.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Metrics.h>
+
+// Qt
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace
+{
+  QMutex s_mutex;               /** protects the values. */
+  QMap<QString, qint64> s_values; /** counter and gauge values. */
+}
+
+//----------------------------------------------------------------------------
+void Metrics::add(const QString &name, const qint64 value)
+{
+  QMutexLocker lock(&s_mutex);
+  s_values[name] += value;
+}
+
+//----------------------------------------------------------------------------
+void Metrics::set(const QString &name, const qint64 value)
+{
+  QMutexLocker lock(&s_mutex);
+  s_values[name] = value;
+}
+
+//----------------------------------------------------------------------------
+qint64 Metrics::value(const QString &name)
+{
+  QMutexLocker lock(&s_mutex);
+  return s_values.value(name, 0);
+}
+
+//----------------------------------------------------------------------------
+QMap<QString, qint64> Metrics::snapshot()
+{
+  QMutexLocker lock(&s_mutex);
+  return s_values;
+}
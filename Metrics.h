@@ -0,0 +1,58 @@
+/*
+ File: Metrics.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+// Qt
+#include <QMap>
+#include <QString>
+
+/**
+ * @brief Application wide counters and gauges. Thread safe.
+ */
+namespace Metrics
+{
+  /**
+   * @brief Adds the given value to a counter.
+   * @param name Counter name.
+   * @param value Value to add.
+   */
+  void add(const QString &name, const qint64 value);
+
+  /**
+   * @brief Sets the value of a gauge.
+   * @param name Gauge name.
+   * @param value Gauge value.
+   */
+  void set(const QString &name, const qint64 value);
+
+  /**
+   * @brief Returns the value of a counter or gauge, 0 if it doesn't exist.
+   * @param name Counter or gauge name.
+   */
+  qint64 value(const QString &name);
+
+  /**
+   * @brief Returns the values of all the counters and gauges.
+   */
+  QMap<QString, qint64> snapshot();
+}
+
+#endif
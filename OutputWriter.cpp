@@ -0,0 +1,214 @@
+/*
+ File: OutputWriter.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <OutputWriter.h>
+#include <Metrics.h>
+
+// Qt
+#include <QThread>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+// C++
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const qint64 HIGH_WATER = 32 * 1024 * 1024; // bytes queued that stop the producer.
+const qint64 LOW_WATER = 8 * 1024 * 1024;   // bytes queued that let the producer continue.
+
+//----------------------------------------------------------------------------
+OutputWriter::OutputWriter(const QString &filename, const qint64 blockSize, const qint64 syncInterval)
+: m_file{filename}
+, m_blockSize{std::max(static_cast<qint64>(4096), blockSize)}
+, m_syncInterval{syncInterval}
+, m_offset{0}
+, m_thread{nullptr}
+, m_closing{false}
+, m_pending{0}
+, m_failed{false}
+{
+}
+
+//----------------------------------------------------------------------------
+OutputWriter::~OutputWriter()
+{
+  close();
+}
+
+//----------------------------------------------------------------------------
+bool OutputWriter::open(const qint64 size, const QCryptographicHash::Algorithm *hash)
+{
+  QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+  if(!m_file.open(QIODevice::WriteOnly|QIODevice::Append|QIODevice::Unbuffered))
+  {
+    m_error = m_file.errorString();
+    return false;
+  }
+
+  m_offset = m_file.size();
+  if(hash && m_offset == 0)
+    m_hash = std::make_unique<QCryptographicHash>(*hash);
+
+  // the allocation doesn't change the size of the file, used as the resume offset.
+  if(size > m_offset)
+  {
+#if defined(Q_OS_WIN)
+    FILE_ALLOCATION_INFO allocation;
+    allocation.AllocationSize.QuadPart = size;
+    SetFileInformationByHandle(reinterpret_cast<HANDLE>(_get_osfhandle(m_file.handle())), FileAllocationInfo, &allocation, sizeof(allocation));
+#elif defined(Q_OS_LINUX)
+    fallocate(m_file.handle(), FALLOC_FL_KEEP_SIZE, 0, size);
+#endif
+  }
+
+  m_thread = QThread::create([this]() { run(); });
+  m_thread->start();
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void OutputWriter::write(const QByteArray &data)
+{
+  if(data.isEmpty() || !m_thread || m_failed) return;
+
+  QMutexLocker lock(&m_mutex);
+  m_queue.push_back(data);
+  m_pending += data.size();
+  m_condition.wakeOne();
+}
+
+//----------------------------------------------------------------------------
+bool OutputWriter::isFull() const
+{
+  return m_pending >= HIGH_WATER;
+}
+
+//----------------------------------------------------------------------------
+bool OutputWriter::isDrained() const
+{
+  return m_pending < LOW_WATER;
+}
+
+//----------------------------------------------------------------------------
+bool OutputWriter::close()
+{
+  if(!m_thread) return !m_failed;
+
+  {
+    QMutexLocker lock(&m_mutex);
+    m_closing = true;
+    m_condition.wakeOne();
+  }
+
+  m_thread->wait();
+  delete m_thread;
+  m_thread = nullptr;
+
+  m_file.close();
+  if(m_hash && !m_failed)
+    m_result = m_hash->result();
+
+  return !m_failed;
+}
+
+//----------------------------------------------------------------------------
+void OutputWriter::run()
+{
+  QByteArray block;
+  qint64 position = m_offset;
+  qint64 unsynced = 0;
+
+  while(true)
+  {
+    std::deque<QByteArray> data;
+    bool closing = false;
+    {
+      QMutexLocker lock(&m_mutex);
+      while(m_queue.empty() && !m_closing)
+        m_condition.wait(&m_mutex);
+
+      data.swap(m_queue);
+      closing = m_closing;
+    }
+
+    qint64 taken = 0;
+    for(const auto &chunk: data)
+    {
+      if(m_hash) m_hash->addData(chunk);
+      block.append(chunk);
+      taken += chunk.size();
+    }
+
+    // writes end at multiples of the block size of the file, the rest waits for more data.
+    const auto aligned = std::max(static_cast<qint64>(0), ((position + block.size()) / m_blockSize) * m_blockSize - position);
+    const auto count = closing ? static_cast<qint64>(block.size()) : aligned;
+    if(m_failed)
+    {
+      block.clear();
+    }
+    else if(count > 0)
+    {
+      if(m_file.write(block.constData(), count) != count)
+      {
+        m_error = m_file.errorString();
+        m_failed = true;
+      }
+
+      position += count;
+      unsynced += count;
+      block.remove(0, count);
+      Metrics::add("output writes", 1);
+    }
+    m_pending -= taken;
+
+    if(closing || (m_syncInterval > 0 && unsynced >= m_syncInterval))
+    {
+      sync();
+      unsynced = 0;
+    }
+
+    if(closing) break;
+  }
+}
+
+//----------------------------------------------------------------------------
+void OutputWriter::sync()
+{
+  if(m_failed) return;
+
+#if defined(Q_OS_WIN)
+  _commit(m_file.handle());
+#elif defined(Q_OS_LINUX)
+  fdatasync(m_file.handle());
+#else
+  fsync(m_file.handle());
+#endif
+  Metrics::add("output syncs", 1);
+}
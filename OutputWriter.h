@@ -0,0 +1,141 @@
+/*
+ File: OutputWriter.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _OUTPUT_WRITER_H_
+#define _OUTPUT_WRITER_H_
+
+// Qt
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QCryptographicHash>
+
+// C++
+#include <atomic>
+#include <deque>
+#include <memory>
+
+class QThread;
+
+/**
+ * @brief Appends the body of a transfer streamed by curl to stdout to the temporal file in a
+ * separate thread. The data is coalesced in unbuffered writes that end at multiples of the block
+ * size, the file is synced every sync interval and when closed, and it's preallocated without
+ * changing its size so the resume offset is still the size of the file. If the file is written
+ * from the beginning the hash of the whole file is computed while writing. The producer must stop
+ * while the data queued is over the high-water mark and continue once it's drained.
+ */
+class OutputWriter
+{
+  public:
+    /**
+     * @brief OutputWriter class constructor.
+     * @param filename Temporal file.
+     * @param blockSize Size of the writes in bytes.
+     * @param syncInterval Bytes written between syncs, 0 to sync only when closed.
+     */
+    OutputWriter(const QString &filename, const qint64 blockSize, const qint64 syncInterval);
+
+    /**
+     * @brief OutputWriter class destructor. Closes the file.
+     */
+    ~OutputWriter();
+
+    /**
+     * @brief Opens the file for appending and starts the writer thread. Returns false on error.
+     * @param size Expected size of the file to preallocate, 0 if unknown.
+     * @param hash Algorithm of the hash of the file if written from the beginning, nullptr for none.
+     */
+    bool open(const qint64 size, const QCryptographicHash::Algorithm *hash);
+
+    /**
+     * @brief Returns the size of the file when opened, the offset of the transfer.
+     */
+    qint64 offset() const
+    { return m_offset; }
+
+    /**
+     * @brief Queues data to be written.
+     * @param data Data of the body.
+     */
+    void write(const QByteArray &data);
+
+    /**
+     * @brief Returns true if the data queued reaches the high-water mark, the producer must stop
+     * until isDrained().
+     */
+    bool isFull() const;
+
+    /**
+     * @brief Returns true if the data queued is under the low-water mark.
+     */
+    bool isDrained() const;
+
+    /**
+     * @brief Returns true if a write has failed, the rest of the data is discarded.
+     */
+    bool hasFailed() const
+    { return m_failed; }
+
+    /**
+     * @brief Writes the data queued, syncs and closes the file. Blocks until done. Returns false if
+     * any write failed.
+     */
+    bool close();
+
+    /**
+     * @brief Returns the hash of the whole file, empty if not computed or not closed.
+     */
+    QByteArray hash() const
+    { return m_result; }
+
+    /**
+     * @brief Returns the text of the last error, valid once hasFailed() returns true.
+     */
+    QString errorString() const
+    { return m_error; }
+
+  private:
+    /**
+     * @brief Writer thread loop.
+     */
+    void run();
+
+    /**
+     * @brief Flushes the data of the file to the disk.
+     */
+    void sync();
+
+    QFile m_file;                 /** temporal file. */
+    const qint64 m_blockSize;     /** size of the writes. */
+    const qint64 m_syncInterval;  /** bytes between syncs, 0 to sync only when closed. */
+    qint64 m_offset;              /** size of the file when opened. */
+    QThread *m_thread;            /** writer thread or nullptr if not open. */
+    QMutex m_mutex;               /** protects the queue and the closing flag. */
+    QWaitCondition m_condition;   /** signals new data or the closing. */
+    std::deque<QByteArray> m_queue; /** data not yet taken by the writer thread. */
+    bool m_closing;               /** true when there is no more data. */
+    std::atomic<qint64> m_pending; /** bytes queued and not yet written. */
+    std::atomic<bool> m_failed;   /** true if a write failed, set by the thread after the error text. */
+    QString m_error;              /** last error text. */
+    std::unique_ptr<QCryptographicHash> m_hash; /** hash of the file or nullptr. */
+    QByteArray m_result;          /** hash of the file once closed. */
+};
+
+#endif
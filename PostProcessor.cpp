@@ -0,0 +1,434 @@
+/*
+ File: PostProcessor.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <PostProcessor.h>
+#include <ArchiveExtractor.h>
+#include <Checksums.h>
+#include <Metrics.h>
+#include <Tracer.h>
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// C++
+#include <algorithm>
+
+const int WAIT_STEP = 100; // milliseconds between checks of the exit and the timeout while a process runs.
+
+namespace
+{
+  /**
+   * @brief Returns the kind of the stage in lower case.
+   * @param stage Stage text.
+   */
+  QString stageKind(const QString &stage)
+  {
+    return stage.trimmed().section(' ', 0, 0).toLower();
+  }
+
+  /**
+   * @brief Returns the argument of the stage, the text after the kind.
+   * @param stage Stage text.
+   */
+  QString stageArgument(const QString &stage)
+  {
+    return stage.trimmed().section(' ', 1).trimmed();
+  }
+
+  /**
+   * @brief Returns the name of the trace event of the stage kind.
+   * @param kind Stage kind.
+   */
+  const char *traceName(const QString &kind)
+  {
+    if(kind == "verify")  return "post-process verify";
+    if(kind == "move")    return "post-process move";
+    if(kind == "extract") return "post-process extract";
+    return "post-process run";
+  }
+}
+
+//----------------------------------------------------------------------------
+PostProcessor::PostProcessor(QObject *parent)
+: QObject(parent)
+, m_nextId{1}
+, m_loaded{false}
+, m_stopping{false}
+{
+}
+
+//----------------------------------------------------------------------------
+PostProcessor::~PostProcessor()
+{
+  m_pool.clear();
+  m_stopping = true;
+  m_pool.waitForDone();
+}
+
+//----------------------------------------------------------------------------
+void PostProcessor::setConfiguration(const Utils::Configuration &config)
+{
+  // the pending jobs follow the metadata folder.
+  const auto previousState = m_loaded ? stateFile() : QString();
+  m_config = config;
+  m_pool.setMaxThreadCount(static_cast<int>(std::max(1u, m_config.postProcessingThreads)));
+
+  if(!m_loaded && !m_config.downloadPath.isEmpty())
+  {
+    m_loaded = true;
+    loadState();
+  }
+  else if(m_loaded && previousState != stateFile())
+  {
+    QFile::remove(previousState);
+    saveState();
+  }
+}
+
+//----------------------------------------------------------------------------
+QStringList PostProcessor::stages(const Utils::ItemInformation &item) const
+{
+  if(!item.postProcessing.isEmpty()) return item.postProcessing;
+
+  for(auto it = m_config.postProcessing.cbegin(); it != m_config.postProcessing.cend(); ++it)
+  {
+    const QRegularExpression pattern(QRegularExpression::wildcardToRegularExpression(it.key()), QRegularExpression::CaseInsensitiveOption);
+    if(pattern.match(item.outputName).hasMatch()) return it.value();
+  }
+
+  return QStringList();
+}
+
+//----------------------------------------------------------------------------
+bool PostProcessor::submit(const Utils::ItemInformation &item, const QString &filename, QObject *waitFor)
+{
+  const auto itemStages = stages(item);
+  if(itemStages.isEmpty()) return false;
+
+  Job job;
+  job.name = item.outputName;
+  job.url = item.url;
+  job.filename = filename;
+  job.stages = itemStages;
+  job.hashes = item.hashes;
+
+  const auto id = m_nextId++;
+  m_jobs.insert(id, job);
+  saveState();
+  Metrics::add("post-processing jobs", 1);
+
+  if(waitFor)
+    connect(waitFor, &QObject::destroyed, this, [this, id]() { runNext(id); });
+  else
+    runNext(id);
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void PostProcessor::runNext(const quint64 id)
+{
+  if(!m_jobs.contains(id)) return;
+
+  const auto job = m_jobs.value(id);
+  const auto extractor = m_config.extractorPath;
+  const auto timeout = m_config.postProcessingTimeout;
+  m_pool.start([this, id, job, extractor, timeout]()
+  {
+    const auto kind = stageKind(job.stages.at(job.stage));
+    QElapsedTimer timer;
+    timer.start();
+
+    Result result;
+    {
+      Tracer::ScopedSpan span(traceName(kind), id);
+      result = runStage(job, extractor, timeout);
+    }
+
+    Metrics::add(QString("post-processing %1 msec").arg(kind), timer.elapsed());
+    if(!result.success) Metrics::add(QString("post-processing %1 failures").arg(kind), 1);
+
+    QMetaObject::invokeMethod(this, [this, id, result]() { onStageDone(id, result); }, Qt::QueuedConnection);
+  });
+}
+
+//----------------------------------------------------------------------------
+void PostProcessor::onStageDone(const quint64 id, const Result &result)
+{
+  if(!m_jobs.contains(id)) return;
+
+  auto &job = m_jobs[id];
+  job.filename = result.filename;
+  ++job.stage;
+
+  if(result.success && job.stage < job.stages.size())
+  {
+    saveState();
+    runNext(id);
+    return;
+  }
+
+  const auto name = job.name;
+  const auto stage = job.stages.at(job.stage - 1);
+  m_jobs.remove(id);
+  saveState();
+
+  if(!result.success)
+  {
+    Metrics::add("post-processing failures", 1);
+    emit finished(name, false, QString("Post-processing of '%1' failed in stage '%2': %3").arg(name).arg(stage).arg(result.message));
+    return;
+  }
+
+  emit finished(name, true, QString("Post-processing of '%1' finished.").arg(name));
+}
+
+//----------------------------------------------------------------------------
+PostProcessor::Result PostProcessor::runStage(const Job &job, const QString &extractor, const unsigned int timeout) const
+{
+  const auto &stage = job.stages.at(job.stage);
+  const auto kind = stageKind(stage);
+  const auto argument = stageArgument(stage);
+
+  Result result;
+  result.filename = job.filename;
+
+  if(kind == "verify")
+  {
+    if(job.hashes.isEmpty())
+    {
+      result.success = true;
+      result.message = "No hashes to verify.";
+      return result;
+    }
+
+    const auto verification = Checksums::verify(job.filename, job.hashes, true);
+    result.success = verification.valid && verification.fileMatches && verification.badPieces() == 0;
+    if(!result.success)
+      result.message = verification.valid ? "The file doesn't match the hashes." : "Unable to read the file.";
+    return result;
+  }
+
+  if(kind == "move")
+  {
+    if(argument.isEmpty())
+    {
+      result.message = "No destination folder.";
+      return result;
+    }
+
+    QDir().mkpath(argument);
+    const auto destination = QDir(argument).absoluteFilePath(QFileInfo(job.filename).fileName());
+
+    // already moved before a restart.
+    if(!QFile::exists(job.filename) && QFile::exists(destination))
+    {
+      result.success = true;
+      result.filename = destination;
+      return result;
+    }
+
+    if(QFile::exists(destination))
+    {
+      result.message = QString("'%1' already exists.").arg(QDir::toNativeSeparators(destination));
+      return result;
+    }
+
+    // rename fails between volumes.
+    result.success = QFile::rename(job.filename, destination) || (QFile::copy(job.filename, destination) && QFile::remove(job.filename));
+    if(result.success)
+      result.filename = destination;
+    else
+      result.message = QString("Unable to move the file to '%1'.").arg(QDir::toNativeSeparators(destination));
+    return result;
+  }
+
+  if(kind == "extract")
+  {
+    const auto format = ArchiveExtractor::format(job.filename);
+    if(format == ArchiveExtractor::Format::NONE)
+    {
+      result.success = true;
+      result.message = "Not an archive.";
+      return result;
+    }
+
+    if(!ArchiveExtractor::isSupported(extractor, format))
+    {
+      result.message = QString("Zip archives need bsdtar, '%1' can't extract them.").arg(extractor);
+      return result;
+    }
+
+    const QFileInfo info(job.filename);
+    const auto folder = info.absoluteDir().absoluteFilePath(ArchiveExtractor::baseName(info.fileName()));
+    QDir().mkpath(folder);
+
+    QStringList arguments{"-x", "-f", job.filename, "-C", folder};
+    if(format == ArchiveExtractor::Format::TAR_GZ) arguments << "-z";
+    if(format == ArchiveExtractor::Format::TAR_ZST) arguments << "--zstd";
+
+    result.success = runProcess(extractor, arguments, timeout, result.message);
+    return result;
+  }
+
+  if(kind == "run")
+  {
+    auto arguments = QProcess::splitCommand(argument);
+    if(arguments.isEmpty())
+    {
+      result.message = "No command.";
+      return result;
+    }
+
+    for(auto &value: arguments)
+    {
+      value.replace("%f", QDir::toNativeSeparators(job.filename));
+      value.replace("%n", job.name);
+      value.replace("%u", job.url.toString());
+    }
+
+    const auto program = arguments.takeFirst();
+    result.success = runProcess(program, arguments, timeout, result.message);
+    return result;
+  }
+
+  result.message = QString("Unknown stage '%1'.").arg(stage);
+  return result;
+}
+
+//----------------------------------------------------------------------------
+bool PostProcessor::runProcess(const QString &program, const QStringList &arguments, const unsigned int timeout, QString &message) const
+{
+  QProcess process;
+  process.setProcessChannelMode(QProcess::ProcessChannelMode::MergedChannels);
+  process.start(program, arguments);
+  if(!process.waitForStarted())
+  {
+    message = QString("Unable to start '%1'.").arg(program);
+    return false;
+  }
+
+  // the process lives in this thread, it's killed here when the timeout expires or the application exits.
+  QElapsedTimer timer;
+  timer.start();
+  while(process.state() != QProcess::ProcessState::NotRunning && !process.waitForFinished(WAIT_STEP))
+  {
+    const auto expired = timeout > 0 && timer.elapsed() >= static_cast<qint64>(timeout) * 1000;
+    if(!expired && !m_stopping) continue;
+
+    process.kill();
+    process.waitForFinished();
+    message = m_stopping ? QString("'%1' killed on exit.").arg(program) : QString("'%1' killed after %2 seconds.").arg(program).arg(timeout);
+    return false;
+  }
+
+  if(process.exitStatus() != QProcess::ExitStatus::NormalExit || process.exitCode() != 0)
+  {
+    const auto output = QString::fromLocal8Bit(process.readAll()).trimmed().right(512);
+    message = QString("'%1' exited with code %2%3").arg(program).arg(process.exitCode()).arg(output.isEmpty() ? QString(".") : ": " + output);
+    return false;
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+QString PostProcessor::stateFile() const
+{
+  return QDir(m_config.metadataFolder()).absoluteFilePath("postprocessing.json");
+}
+
+//----------------------------------------------------------------------------
+void PostProcessor::saveState() const
+{
+  if(m_config.downloadPath.isEmpty()) return;
+
+  if(m_jobs.isEmpty())
+  {
+    QFile::remove(stateFile());
+    return;
+  }
+
+  QJsonArray jobs;
+  for(const auto &job: m_jobs)
+  {
+    QJsonArray pieces;
+    for(const auto &piece: job.hashes.pieces)
+      pieces.append(QString::fromLatin1(piece.toHex()));
+
+    QJsonObject object;
+    object.insert("name", job.name);
+    object.insert("url", job.url.toString());
+    object.insert("file", job.filename);
+    object.insert("stages", QJsonArray::fromStringList(job.stages.mid(job.stage)));
+    object.insert("hashType", job.hashes.type);
+    object.insert("hash", QString::fromLatin1(job.hashes.hash.toHex()));
+    object.insert("pieceType", job.hashes.pieceType);
+    object.insert("pieceLength", job.hashes.pieceLength);
+    object.insert("pieces", pieces);
+    jobs.append(object);
+  }
+
+  QDir().mkpath(m_config.metadataFolder());
+  QFile file(stateFile());
+  if(file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+    file.write(QJsonDocument(jobs).toJson(QJsonDocument::Compact));
+}
+
+//----------------------------------------------------------------------------
+void PostProcessor::loadState()
+{
+  QFile file(stateFile());
+  if(!file.open(QIODevice::ReadOnly)) return;
+
+  for(const auto value: QJsonDocument::fromJson(file.readAll()).array())
+  {
+    const auto object = value.toObject();
+
+    Job job;
+    job.name = object.value("name").toString();
+    job.url = QUrl(object.value("url").toString());
+    job.filename = object.value("file").toString();
+    for(const auto stage: object.value("stages").toArray())
+      job.stages << stage.toString();
+    job.hashes.type = object.value("hashType").toString();
+    job.hashes.hash = QByteArray::fromHex(object.value("hash").toString().toLatin1());
+    job.hashes.pieceType = object.value("pieceType").toString();
+    job.hashes.pieceLength = object.value("pieceLength").toInteger();
+    for(const auto piece: object.value("pieces").toArray())
+      job.hashes.pieces << QByteArray::fromHex(piece.toString().toLatin1());
+
+    if(job.filename.isEmpty() || job.stages.isEmpty()) continue;
+
+    m_jobs.insert(m_nextId++, job);
+  }
+  file.close();
+
+  for(const auto id: m_jobs.keys())
+    runNext(id);
+}
@@ -0,0 +1,171 @@
+/*
+ File: PostProcessor.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POST_PROCESSOR_H_
+#define _POST_PROCESSOR_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QObject>
+#include <QThreadPool>
+#include <QMap>
+
+// C++
+#include <atomic>
+
+/**
+ * @brief Runs the post-processing stages of the downloaded files in a bounded thread pool. The
+ * stages are 'verify' (hashes of the item), 'move <folder>', 'extract' (tar archives, in a folder
+ * with the name of the file) and 'run <command>' (%f is replaced by the file, %n by its name and
+ * %u by the url). The stages of an item are its own or the ones of the first pattern that matches
+ * its name. The pending stages are stored in the metadata folder and continue after a restart.
+ */
+class PostProcessor
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /**
+     * @brief PostProcessor class constructor.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    explicit PostProcessor(QObject *parent = nullptr);
+
+    /**
+     * @brief PostProcessor class virtual destructor. Kills the processes of the running stages and
+     * waits for them, those and the rest run in the next execution.
+     */
+    virtual ~PostProcessor();
+
+    /**
+     * @brief Sets the configuration, the first time the stored pending stages are started.
+     * @param config Application configuration.
+     */
+    void setConfiguration(const Utils::Configuration &config);
+
+    /**
+     * @brief Returns the stages to run for the item, empty if none.
+     * @param item Item information.
+     */
+    QStringList stages(const Utils::ItemInformation &item) const;
+
+    /**
+     * @brief Queues the post-processing of a downloaded file. Returns false if it has no stages.
+     * @param item Item information.
+     * @param filename Downloaded file.
+     * @param waitFor Object that uses the file and must be destroyed before starting, or nullptr.
+     */
+    bool submit(const Utils::ItemInformation &item, const QString &filename, QObject *waitFor = nullptr);
+
+    /**
+     * @brief Returns the number of files being post-processed.
+     */
+    int pending() const
+    { return m_jobs.size(); }
+
+  signals:
+    /**
+     * @brief Emitted when the stages of a file end.
+     * @param name Name of the file.
+     * @param success True if all the stages succeeded.
+     * @param message Result text.
+     */
+    void finished(const QString &name, bool success, const QString &message);
+
+  private:
+    /**
+     * @brief Post-processing of a file.
+     */
+    struct Job
+    {
+      QString name;             /** name of the item. */
+      QUrl url;                 /** url of the item. */
+      QString filename;         /** current location of the file. */
+      QStringList stages;       /** stages to run. */
+      int stage = 0;            /** index of the next stage. */
+      Utils::FileHashes hashes; /** hashes of the file. */
+    };
+
+    /**
+     * @brief Result of a stage.
+     */
+    struct Result
+    {
+      bool success = false; /** true if the stage succeeded. */
+      QString filename;     /** location of the file after the stage. */
+      QString message;      /** result text. */
+    };
+
+    /**
+     * @brief Starts the next stage of the job in the thread pool.
+     * @param id Job identifier.
+     */
+    void runNext(const quint64 id);
+
+    /**
+     * @brief Handles the result of a stage in the main thread.
+     * @param id Job identifier.
+     * @param result Stage result.
+     */
+    void onStageDone(const quint64 id, const Result &result);
+
+    /**
+     * @brief Runs a stage, called from the thread pool.
+     * @param job Job information.
+     * @param extractor Path of the tar executable.
+     * @param timeout Seconds the process of the stage can run, 0 for no limit.
+     */
+    Result runStage(const Job &job, const QString &extractor, const unsigned int timeout) const;
+
+    /**
+     * @brief Runs a process until it ends, it's killed if the timeout expires or the application
+     * exits. Returns true if it exited with code 0.
+     * @param program Executable.
+     * @param arguments Arguments of the executable.
+     * @param timeout Seconds the process can run, 0 for no limit.
+     * @param message Error text if failed.
+     */
+    bool runProcess(const QString &program, const QStringList &arguments, const unsigned int timeout, QString &message) const;
+
+    /**
+     * @brief Returns the file with the pending jobs.
+     */
+    QString stateFile() const;
+
+    /**
+     * @brief Stores the pending jobs.
+     */
+    void saveState() const;
+
+    /**
+     * @brief Loads and starts the stored pending jobs.
+     */
+    void loadState();
+
+    QThreadPool m_pool;                 /** stages pool. */
+    Utils::Configuration m_config;      /** application configuration. */
+    QMap<quint64, Job> m_jobs;          /** files being post-processed. */
+    quint64 m_nextId;                   /** identifier of the next job. */
+    bool m_loaded;                      /** true once the stored jobs have been loaded. */
+    std::atomic<bool> m_stopping;       /** true when the application exits, the running processes are killed. */
+};
+
+#endif
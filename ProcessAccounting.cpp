@@ -0,0 +1,234 @@
+/*
+ File: ProcessAccounting.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ProcessAccounting.h>
+#include <Metrics.h>
+
+// Qt
+#include <QFile>
+#include <QLocale>
+
+// C++
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+  /**
+   * @brief Returns the values of a /proc file with 'key: value' lines, the units are ignored.
+   * @param filename File name.
+   */
+  [[maybe_unused]] QHash<QString, qint64> readValues(const QString &filename)
+  {
+    QHash<QString, qint64> values;
+
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)) return values;
+
+    for(const auto &line: QString::fromLatin1(file.readAll()).split('\n', Qt::SkipEmptyParts))
+    {
+      const auto separator = line.indexOf(':');
+      if(separator <= 0) continue;
+
+      const auto value = line.mid(separator + 1).trimmed().split(' ').first();
+      values.insert(line.left(separator), value.toLongLong());
+    }
+
+    return values;
+  }
+
+#ifdef Q_OS_WIN
+  /**
+   * @brief Reads the cumulative usage of a process from its handle. Returns false if not available.
+   * @param handle Process handle.
+   * @param usage Usage of the process.
+   */
+  bool readHandle(HANDLE handle, ProcessAccounting::Usage &usage)
+  {
+    // times in 100 nanoseconds units.
+    FILETIME creation, exitTime, kernel, user;
+    const auto valid = GetProcessTimes(handle, &creation, &exitTime, &kernel, &user);
+    if(valid)
+    {
+      const auto toMsec = [](const FILETIME &time) { return ((static_cast<qint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10000; };
+      usage.cpuMsec = toMsec(kernel) + toMsec(user);
+    }
+
+    IO_COUNTERS io;
+    if(GetProcessIoCounters(handle, &io))
+    {
+      usage.readBytes = static_cast<qint64>(io.ReadTransferCount);
+      usage.writeBytes = static_cast<qint64>(io.WriteTransferCount);
+    }
+
+    PROCESS_MEMORY_COUNTERS memory;
+    if(K32GetProcessMemoryInfo(handle, &memory, sizeof(memory)))
+      usage.peakMemory = static_cast<qint64>(memory.PeakWorkingSetSize);
+
+    return valid;
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------
+QString ProcessAccounting::Usage::toText() const
+{
+  const QLocale locale;
+  auto text = QString("CPU %1 s, peak memory %2, read %3, written %4").arg(cpuMsec / 1000.0, 0, 'f', 1)
+                .arg(locale.formattedDataSize(peakMemory)).arg(locale.formattedDataSize(readBytes)).arg(locale.formattedDataSize(writeBytes));
+  if(contextSwitches > 0)
+    text += QString(", %1 context switches").arg(contextSwitches);
+
+  return text;
+}
+
+//----------------------------------------------------------------------------
+ProcessAccounting::~ProcessAccounting()
+{
+#ifdef Q_OS_WIN
+  for(const auto handle: m_handles)
+    CloseHandle(handle);
+#endif
+}
+
+//----------------------------------------------------------------------------
+void ProcessAccounting::sample(const QList<qint64> &pids)
+{
+  QHash<qint64, Usage> current;
+
+  for(const auto pid: pids)
+  {
+    Usage usage;
+    if(pid <= 0 || !readProcess(pid, usage)) continue;
+
+    add(usage, m_last.value(pid));
+    current.insert(pid, usage);
+  }
+
+  // the ended processes are read one last time, only possible with a kept handle.
+  for(auto it = m_last.cbegin(); it != m_last.cend(); ++it)
+  {
+    if(current.contains(it.key())) continue;
+
+    Usage usage;
+    if(m_handles.contains(it.key()) && readProcess(it.key(), usage))
+      add(usage, it.value());
+  }
+
+#ifdef Q_OS_WIN
+  for(auto it = m_handles.begin(); it != m_handles.end();)
+  {
+    if(current.contains(it.key()))
+    {
+      ++it;
+      continue;
+    }
+
+    CloseHandle(it.value());
+    it = m_handles.erase(it);
+  }
+#endif
+
+  m_last = current;
+}
+
+//----------------------------------------------------------------------------
+void ProcessAccounting::add(const Usage &usage, const Usage &last)
+{
+  // the counters are cumulative, only the growth since the last sample is added.
+  const auto cpu = std::max(0ll, usage.cpuMsec - last.cpuMsec);
+  const auto readBytes = std::max(0ll, usage.readBytes - last.readBytes);
+  const auto writeBytes = std::max(0ll, usage.writeBytes - last.writeBytes);
+  const auto switches = std::max(0ll, usage.contextSwitches - last.contextSwitches);
+
+  m_total.cpuMsec += cpu;
+  m_total.readBytes += readBytes;
+  m_total.writeBytes += writeBytes;
+  m_total.contextSwitches += switches;
+  m_total.peakMemory = std::max(m_total.peakMemory, usage.peakMemory);
+
+  Metrics::add("process cpu msec", cpu);
+  Metrics::add("process read bytes", readBytes);
+  Metrics::add("process write bytes", writeBytes);
+  Metrics::add("process context switches", switches);
+  if(usage.peakMemory > Metrics::value("process peak memory"))
+    Metrics::set("process peak memory", usage.peakMemory);
+}
+
+//----------------------------------------------------------------------------
+bool ProcessAccounting::readProcess(const qint64 pid, Usage &usage)
+{
+#ifdef Q_OS_WIN
+  auto handle = m_handles.value(pid, nullptr);
+  if(!handle)
+  {
+    handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if(!handle) return false;
+
+    m_handles.insert(pid, handle);
+  }
+
+  return readHandle(handle, usage);
+#else
+  return read(pid, usage);
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool ProcessAccounting::read(const qint64 pid, Usage &usage)
+{
+#ifdef Q_OS_WIN
+  auto handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+  if(!handle) return false;
+
+  const auto valid = readHandle(handle, usage);
+  CloseHandle(handle);
+  return valid;
+#else
+  QFile stat(QString("/proc/%1/stat").arg(pid));
+  if(!stat.open(QIODevice::ReadOnly)) return false;
+
+  // the command name can have spaces, the fields start after it: utime and stime are 14 and 15.
+  const auto text = QString::fromLatin1(stat.readAll());
+  const auto fields = text.mid(text.lastIndexOf(')') + 2).split(' ', Qt::SkipEmptyParts);
+  if(fields.size() < 13) return false;
+
+  static const qint64 ticks = std::max(1l, sysconf(_SC_CLK_TCK));
+  usage.cpuMsec = (fields.at(11).toLongLong() + fields.at(12).toLongLong()) * 1000 / ticks;
+
+  const auto status = readValues(QString("/proc/%1/status").arg(pid));
+  usage.peakMemory = status.value("VmHWM") * 1024;
+  usage.contextSwitches = status.value("voluntary_ctxt_switches") + status.value("nonvoluntary_ctxt_switches");
+
+  // only readable by the same user.
+  const auto io = readValues(QString("/proc/%1/io").arg(pid));
+  usage.readBytes = io.value("read_bytes");
+  usage.writeBytes = io.value("write_bytes");
+
+  return true;
+#endif
+}
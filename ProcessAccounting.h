@@ -0,0 +1,103 @@
+/*
+ File: ProcessAccounting.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PROCESS_ACCOUNTING_H_
+#define _PROCESS_ACCOUNTING_H_
+
+// Qt
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Resource usage of the curl processes of an item, from periodic samples of each process:
+ * /proc/<pid> in Linux and the process counters in Windows. The usage of each process is added to
+ * the totals of the item and to the application metrics 'process cpu msec', 'process read bytes',
+ * 'process write bytes', 'process context switches' and 'process peak memory'. In Windows the
+ * handle of each process sampled is kept open so its final usage is read once it ends; elsewhere
+ * the usage after the last sample of a process is lost, so the processes must be sampled when
+ * they start and before they're killed.
+ */
+class ProcessAccounting
+{
+  public:
+    /**
+     * @brief Resource usage.
+     */
+    struct Usage
+    {
+      qint64 cpuMsec = 0;         /** user and system CPU time in milliseconds. */
+      qint64 peakMemory = 0;      /** peak resident memory in bytes. */
+      qint64 readBytes = 0;       /** bytes read from storage. */
+      qint64 writeBytes = 0;      /** bytes written to storage. */
+      qint64 contextSwitches = 0; /** voluntary and involuntary context switches, not available in Windows. */
+
+      /**
+       * @brief Returns the usage as text.
+       */
+      QString toText() const;
+    };
+
+    /**
+     * @brief ProcessAccounting class destructor. Closes the kept process handles.
+     */
+    ~ProcessAccounting();
+
+    /**
+     * @brief Samples the given processes and forgets the ones not in the list, that have ended,
+     * after reading their final usage if possible.
+     * @param pids Process identifiers of the running processes.
+     */
+    void sample(const QList<qint64> &pids);
+
+    /**
+     * @brief Returns the usage of all the processes sampled.
+     */
+    const Usage &total() const
+    { return m_total; }
+
+    /**
+     * @brief Reads the cumulative usage of a process. Returns false if not available.
+     * @param pid Process identifier.
+     * @param usage Usage of the process.
+     */
+    static bool read(const qint64 pid, Usage &usage);
+
+  private:
+    /**
+     * @brief Reads the cumulative usage of a process, with its kept handle in Windows. Returns
+     * false if not available.
+     * @param pid Process identifier.
+     * @param usage Usage of the process.
+     */
+    bool readProcess(const qint64 pid, Usage &usage);
+
+    /**
+     * @brief Adds the growth of the usage of a process since its last sample to the totals.
+     * @param usage Current usage of the process.
+     * @param last Usage of the previous sample.
+     */
+    void add(const Usage &usage, const Usage &last);
+
+    QHash<qint64, Usage> m_last;         /** last sample of each running process. */
+    QHash<qint64, Qt::HANDLE> m_handles; /** handles of the processes sampled in Windows, valid after they end. */
+    Usage m_total;                       /** usage of all the processes. */
+};
+
+#endif
@@ -0,0 +1,233 @@
+/*
+ File: ProcessLimits.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ProcessLimits.h>
+#include <Metrics.h>
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+// C++
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace
+{
+  const int CPU_PERIOD = 100000; // microseconds of the cpu.max period.
+
+  /**
+   * @brief Writes a value in a file of the cgroup. Returns false on error.
+   * @param cgroup cgroup directory.
+   * @param file File name.
+   * @param value Value text.
+   */
+  [[maybe_unused]] bool writeValue(const QString &cgroup, const QString &file, const QString &value)
+  {
+    QFile control(QDir(cgroup).filePath(file));
+    if(!control.open(QIODevice::WriteOnly|QIODevice::Text)) return false;
+
+    return control.write(value.toUtf8()) == value.toUtf8().size();
+  }
+
+  /**
+   * @brief Returns the contents of a file of the cgroup, empty on error.
+   * @param cgroup cgroup directory.
+   * @param file File name.
+   */
+  QString readValue(const QString &cgroup, const QString &file)
+  {
+    QFile control(QDir(cgroup).filePath(file));
+    if(!control.open(QIODevice::ReadOnly|QIODevice::Text)) return QString();
+
+    return QString::fromUtf8(control.readAll());
+  }
+
+  /**
+   * @brief Returns the I/O priority value of the ioprio_set syscall for the given class name, -1
+   * to keep the default.
+   * @param name Class name.
+   */
+  [[maybe_unused]] int ioPriority(const QString &name)
+  {
+    const int CLASS_SHIFT = 13;
+    const int BEST_EFFORT = 2;
+    const int IDLE = 3;
+    const int LOWEST_LEVEL = 7;
+
+    if(name.compare("idle", Qt::CaseInsensitive) == 0) return IDLE << CLASS_SHIFT;
+    if(name.compare("best-effort", Qt::CaseInsensitive) == 0) return (BEST_EFFORT << CLASS_SHIFT) | LOWEST_LEVEL;
+
+    return -1;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ProcessLimits::setup(const Utils::Configuration &config, QString &error)
+{
+  const auto cgroup = config.processCgroup;
+  if(cgroup.isEmpty()) return true;
+
+#ifdef Q_OS_LINUX
+  if(!QDir().mkpath(cgroup) || !QFile::exists(QDir(cgroup).filePath("cgroup.procs")))
+  {
+    error = QString("'%1' is not a cgroup v2 directory.").arg(cgroup);
+    return false;
+  }
+
+  // the controllers must be enabled by the parent, it fails if the parent has processes.
+  QStringList controllers;
+  if(config.processCpuWeight > 0 || config.processCpuMax > 0) controllers << "+cpu";
+  if(config.processIoWeight > 0) controllers << "+io";
+  if(config.processMemoryMax > 0) controllers << "+memory";
+  const auto parent = QFileInfo(QDir::cleanPath(cgroup)).absolutePath();
+  for(const auto &controller: controllers)
+    writeValue(parent, "cgroup.subtree_control", controller);
+
+  QStringList failed;
+  if(config.processCpuWeight > 0 && !writeValue(cgroup, "cpu.weight", QString::number(std::clamp(config.processCpuWeight, 1u, 10000u))))
+    failed << "cpu.weight";
+  if(config.processIoWeight > 0 && !writeValue(cgroup, "io.weight", QString("default %1").arg(std::clamp(config.processIoWeight, 1u, 10000u))))
+    failed << "io.weight";
+  if(config.processCpuMax > 0 && !writeValue(cgroup, "cpu.max", QString("%1 %2").arg(static_cast<qint64>(config.processCpuMax) * CPU_PERIOD / 100).arg(CPU_PERIOD)))
+    failed << "cpu.max";
+  if(config.processMemoryMax > 0 && !writeValue(cgroup, "memory.max", QString::number(static_cast<qint64>(config.processMemoryMax) * 1024 * 1024)))
+    failed << "memory.max";
+
+  if(!failed.isEmpty())
+  {
+    error = QString("Unable to set %1 of the cgroup '%2', the controllers aren't enabled or delegated.").arg(failed.join(", ")).arg(cgroup);
+    return false;
+  }
+
+  return true;
+#else
+  error = "cgroups are only available in Linux.";
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void ProcessLimits::apply(QProcess &process, const Utils::Configuration &config)
+{
+#ifdef Q_OS_WIN
+  if(config.processNice == 0) return;
+
+  const DWORD priorityClass = config.processNice >= 15 ? IDLE_PRIORITY_CLASS : BELOW_NORMAL_PRIORITY_CLASS;
+  process.setCreateProcessArgumentsModifier([priorityClass](QProcess::CreateProcessArguments *arguments)
+  {
+    arguments->flags |= priorityClass;
+  });
+#else
+  const int nice = static_cast<int>(std::min(config.processNice, 19u));
+  const int ioClass = ioPriority(config.processIoClass);
+  const auto procs = config.processCgroup.isEmpty() ? QByteArray() : QFile::encodeName(QDir(config.processCgroup).filePath("cgroup.procs"));
+  if(nice == 0 && ioClass == -1 && procs.isEmpty()) return;
+
+  // runs in the child after fork, only async-signal-safe calls.
+  process.setChildProcessModifier([nice, ioClass, procs]()
+  {
+    if(nice > 0) setpriority(PRIO_PROCESS, 0, nice);
+
+#ifdef Q_OS_LINUX
+    const int IOPRIO_WHO_PROCESS = 1;
+    if(ioClass != -1) syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, ioClass);
+
+    // writing 0 moves the writing process.
+    if(!procs.isEmpty())
+    {
+      const int fd = ::open(procs.constData(), O_WRONLY|O_CLOEXEC);
+      if(fd >= 0)
+      {
+        [[maybe_unused]] const auto written = ::write(fd, "0", 1);
+        ::close(fd);
+      }
+    }
+#endif
+  });
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool ProcessLimits::suspend(const qint64 pid, const bool suspended)
+{
+  if(pid <= 0) return false;
+
+#ifdef Q_OS_WIN
+  // undocumented but stable since Windows XP, suspends all the threads of the process.
+  using ProcessFunction = LONG (NTAPI *)(HANDLE);
+  const auto function = reinterpret_cast<ProcessFunction>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), suspended ? "NtSuspendProcess" : "NtResumeProcess"));
+  if(!function) return false;
+
+  const auto handle = OpenProcess(PROCESS_SUSPEND_RESUME, FALSE, static_cast<DWORD>(pid));
+  if(!handle) return false;
+
+  const auto result = function(handle) >= 0;
+  CloseHandle(handle);
+  return result;
+#else
+  return ::kill(static_cast<pid_t>(pid), suspended ? SIGSTOP : SIGCONT) == 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void ProcessLimits::updateMetrics(const Utils::Configuration &config)
+{
+  const auto cgroup = config.processCgroup;
+  if(cgroup.isEmpty()) return;
+
+  for(const auto &line: readValue(cgroup, "cpu.stat").split('\n', Qt::SkipEmptyParts))
+  {
+    const auto parts = line.split(' ', Qt::SkipEmptyParts);
+    if(parts.size() == 2 && parts.first() == "usage_usec")
+      Metrics::set("curl cpu msec", parts.last().toLongLong() / 1000);
+  }
+
+  // memory.peak needs a recent kernel.
+  auto memory = readValue(cgroup, "memory.peak").trimmed();
+  if(memory.isEmpty()) memory = readValue(cgroup, "memory.current").trimmed();
+  if(!memory.isEmpty()) Metrics::set("curl memory peak", memory.toLongLong());
+
+  // one line per device: '<major>:<minor> rbytes=<n> wbytes=<n> ...'.
+  qint64 readBytes = 0, writeBytes = 0;
+  for(const auto &line: readValue(cgroup, "io.stat").split('\n', Qt::SkipEmptyParts))
+  {
+    for(const auto &field: line.split(' ', Qt::SkipEmptyParts))
+    {
+      if(field.startsWith("rbytes=")) readBytes += field.mid(7).toLongLong();
+      else if(field.startsWith("wbytes=")) writeBytes += field.mid(7).toLongLong();
+    }
+  }
+  Metrics::set("curl read bytes", readBytes);
+  Metrics::set("curl write bytes", writeBytes);
+}
@@ -0,0 +1,67 @@
+/*
+ File: ProcessLimits.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PROCESS_LIMITS_H_
+#define _PROCESS_LIMITS_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QProcess>
+
+/**
+ * @brief CPU and I/O priority and resource limits of the curl processes. In Windows the nice value
+ * selects the priority class of the process. Elsewhere the nice value and the I/O class are set in
+ * the child before running curl and, in Linux, the process is placed in a cgroup v2 with the
+ * configured weights and maximums.
+ */
+namespace ProcessLimits
+{
+  /**
+   * @brief Creates the cgroup of the curl processes, if configured, and writes its limits. Returns
+   * false and the reason if the cgroup can't be used, the processes run without it.
+   * @param config Application configuration.
+   * @param error Error text.
+   */
+  bool setup(const Utils::Configuration &config, QString &error);
+
+  /**
+   * @brief Makes the process start with the configured priority and limits.
+   * @param process Process not started.
+   * @param config Application configuration.
+   */
+  void apply(QProcess &process, const Utils::Configuration &config);
+
+  /**
+   * @brief Stops or continues a running process. Returns false on error.
+   * @param pid Process identifier.
+   * @param suspended True to stop the process and false to continue it.
+   */
+  bool suspend(const qint64 pid, const bool suspended);
+
+  /**
+   * @brief Updates the usage metrics of the cgroup of the curl processes: 'curl cpu msec',
+   * 'curl memory peak', 'curl read bytes' and 'curl write bytes'. Does nothing without a cgroup.
+   * @param config Application configuration.
+   */
+  void updateMetrics(const Utils::Configuration &config);
+}
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ File: ProxyPool.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ProxyPool.h>
+#include <Metrics.h>
+
+// Qt
+#include <QTcpSocket>
+#include <QElapsedTimer>
+
+// C++
+#include <limits>
+#include <memory>
+
+const int PROBE_TIMEOUT_MS = 5000;
+const int UNKNOWN_LATENCY_MS = 1000;
+
+//----------------------------------------------------------------------------
+QString ProxyPool::Proxy::toText() const
+{
+  return QString("%1://%2:%3").arg(protocol == Utils::Protocol::SOCKS4 ? "socks4" : "socks5").arg(server).arg(port);
+}
+
+//----------------------------------------------------------------------------
+ProxyPool::ProxyPool(QObject *parent)
+: QObject(parent)
+{
+  m_timer.setInterval(60 * 1000);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(probe()));
+}
+
+//----------------------------------------------------------------------------
+void ProxyPool::setProxies(const QStringList &proxies)
+{
+  std::vector<Proxy> newProxies;
+
+  for(const auto &text: proxies)
+  {
+    Proxy proxy;
+    if(!parse(text, proxy)) continue;
+
+    auto sameProxy = [&proxy](const Proxy &other) { return other.toText() == proxy.toText(); };
+    if(std::find_if(newProxies.cbegin(), newProxies.cend(), sameProxy) != newProxies.cend()) continue;
+
+    auto it = std::find_if(m_proxies.cbegin(), m_proxies.cend(), sameProxy);
+    newProxies.push_back(it != m_proxies.cend() ? *it : proxy);
+  }
+
+  m_proxies = newProxies;
+
+  if(m_proxies.empty())
+  {
+    m_timer.stop();
+    return;
+  }
+
+  if(!m_timer.isActive()) m_timer.start();
+  probe();
+}
+
+//----------------------------------------------------------------------------
+void ProxyPool::setProbeInterval(const unsigned int seconds)
+{
+  m_timer.setInterval(std::max(5u, seconds) * 1000);
+}
+
+//----------------------------------------------------------------------------
+bool ProxyPool::assign(Utils::ItemInformation *item)
+{
+  if(m_proxies.empty()) return false;
+
+  auto current = find(item);
+
+  Proxy *best = nullptr;
+  auto bestCost = std::numeric_limits<double>::max();
+  for(auto &proxy: m_proxies)
+  {
+    if(&proxy == current && m_proxies.size() > 1) continue;
+
+    const auto proxyCost = cost(proxy);
+    if(!best || proxyCost < bestCost)
+    {
+      best = &proxy;
+      bestCost = proxyCost;
+    }
+  }
+
+  if(!best || best == current)
+    return false;
+
+  if(current && current->activeItems > 0) --current->activeItems;
+  ++best->activeItems;
+
+  item->server = best->server;
+  item->port = best->port;
+  item->protocol = best->protocol;
+
+  Metrics::add("proxy assignments", 1);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ProxyPool::release(const Utils::ItemInformation *item)
+{
+  auto proxy = find(item);
+  if(proxy && proxy->activeItems > 0)
+    --proxy->activeItems;
+}
+
+//----------------------------------------------------------------------------
+void ProxyPool::reportFailure(const Utils::ItemInformation *item)
+{
+  auto proxy = find(item);
+  if(proxy)
+  {
+    ++proxy->failures;
+    Metrics::add("proxy failures", 1);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ProxyPool::reportThroughput(const Utils::ItemInformation *item, const double bytesPerSecond)
+{
+  auto proxy = find(item);
+  if(!proxy || bytesPerSecond <= 0) return;
+
+  // exponentially weighted moving average.
+  proxy->throughput = (proxy->throughput == 0) ? bytesPerSecond : 0.7 * proxy->throughput + 0.3 * bytesPerSecond;
+  proxy->failures = 0;
+}
+
+//----------------------------------------------------------------------------
+bool ProxyPool::parse(const QString &text, Proxy &proxy)
+{
+  const QUrl url(text.trimmed());
+  if(!url.isValid() || url.host().isEmpty() || url.port() <= 0) return false;
+
+  const auto scheme = url.scheme().toLower();
+  if(scheme == "socks4")
+    proxy.protocol = Utils::Protocol::SOCKS4;
+  else if(scheme == "socks5")
+    proxy.protocol = Utils::Protocol::SOCKS5;
+  else
+    return false;
+
+  proxy.server = url.host();
+  proxy.port = url.port();
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ProxyPool::probe()
+{
+  for(std::size_t i = 0; i < m_proxies.size(); ++i)
+    probeProxy(i);
+}
+
+//----------------------------------------------------------------------------
+void ProxyPool::probeProxy(const std::size_t index)
+{
+  const auto key = m_proxies.at(index).toText();
+  const auto isSocks5 = m_proxies.at(index).protocol == Utils::Protocol::SOCKS5;
+
+  auto socket = new QTcpSocket(this);
+  auto elapsed = std::make_shared<QElapsedTimer>();
+  auto done = std::make_shared<bool>(false);
+
+  auto finish = [this, key, socket, elapsed, done](const bool healthy)
+  {
+    if(*done) return;
+    *done = true;
+
+    auto it = std::find_if(m_proxies.begin(), m_proxies.end(), [&key](const Proxy &p) { return p.toText() == key; });
+    if(it != m_proxies.end())
+    {
+      it->healthy = healthy;
+      it->latency = healthy ? static_cast<int>(elapsed->elapsed()) : -1;
+    }
+
+    socket->abort();
+    socket->deleteLater();
+  };
+
+  connect(socket, &QTcpSocket::connected, this, [socket, isSocks5, finish]()
+  {
+    // SOCKS5 greeting with the 'no authentication' method, SOCKS4 has no request without a destination.
+    if(isSocks5)
+      socket->write(QByteArray::fromHex("050100"));
+    else
+      finish(true);
+  });
+
+  connect(socket, &QTcpSocket::readyRead, this, [socket, finish]()
+  {
+    const auto reply = socket->read(2);
+    finish(reply.size() == 2 && reply.at(0) == 0x05 && static_cast<unsigned char>(reply.at(1)) != 0xFF);
+  });
+
+  connect(socket, &QTcpSocket::errorOccurred, this, [finish]() { finish(false); });
+  QTimer::singleShot(PROBE_TIMEOUT_MS, socket, [finish]() { finish(false); });
+
+  elapsed->start();
+  socket->connectToHost(m_proxies.at(index).server, m_proxies.at(index).port);
+}
+
+//----------------------------------------------------------------------------
+ProxyPool::Proxy *ProxyPool::find(const Utils::ItemInformation *item)
+{
+  auto isItemProxy = [item](const Proxy &p)
+  {
+    return p.server == item->server && p.port == item->port && p.protocol == item->protocol;
+  };
+
+  auto it = std::find_if(m_proxies.begin(), m_proxies.end(), isItemProxy);
+  return it == m_proxies.end() ? nullptr : &(*it);
+}
+
+//----------------------------------------------------------------------------
+double ProxyPool::cost(const Proxy &proxy)
+{
+  // unhealthy proxies are only used if there are no healthy ones.
+  const double unhealthyPenalty = proxy.healthy ? 0 : 1e6;
+  const double latency = proxy.latency >= 0 ? proxy.latency : UNKNOWN_LATENCY_MS;
+
+  // latency weighted by load, reduced by the measured throughput (in 64KB/s units), plus the failures.
+  return unhealthyPenalty + latency * (1 + proxy.activeItems) / (1 + proxy.throughput / 65536) + proxy.failures * 2000.0;
+}
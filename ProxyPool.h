@@ -0,0 +1,156 @@
+/*
+ File: ProxyPool.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PROXY_POOL_H_
+#define _PROXY_POOL_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QObject>
+#include <QTimer>
+#include <QStringList>
+
+// C++
+#include <vector>
+
+/**
+ * @brief Pool of SOCKS proxies health-checked and latency-probed in the background. Items
+ * using the pool are assigned the proxy with the best score and moved to another healthy
+ * proxy when their transfer fails or stalls.
+ */
+class ProxyPool
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /**
+     * @brief Proxy information and statistics.
+     */
+    struct Proxy
+    {
+      QString server;                                /** proxy address. */
+      unsigned int port = 0;                         /** proxy port. */
+      Utils::Protocol protocol = Utils::Protocol::SOCKS5; /** proxy protocol. */
+      bool healthy = false;                          /** true if the last probe succeeded. */
+      int latency = -1;                              /** latency of the last probe in milliseconds, -1 if unknown. */
+      double throughput = 0;                         /** average throughput of the transfers in bytes per second. */
+      unsigned int failures = 0;                     /** consecutive failures reported by the transfers. */
+      unsigned int activeItems = 0;                  /** number of items using the proxy. */
+
+      /**
+       * @brief Returns the proxy as text in the 'protocol://server:port' format.
+       */
+      QString toText() const;
+    };
+
+    /**
+     * @brief ProxyPool class constructor.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    explicit ProxyPool(QObject *parent = nullptr);
+
+    /**
+     * @brief ProxyPool class virtual destructor.
+     */
+    virtual ~ProxyPool()
+    {};
+
+    /**
+     * @brief Sets the proxies of the pool, keeping the statistics of the existing ones.
+     * @param proxies List of proxies in the 'socks4://server:port' or 'socks5://server:port' format.
+     */
+    void setProxies(const QStringList &proxies);
+
+    /**
+     * @brief Sets the interval between probes.
+     * @param seconds Interval in seconds.
+     */
+    void setProbeInterval(const unsigned int seconds);
+
+    /**
+     * @brief Returns true if the pool has no proxies.
+     */
+    bool isEmpty() const
+    { return m_proxies.empty(); }
+
+    /**
+     * @brief Assigns the best proxy to the item, different from the one it is using if possible.
+     * Returns true if the proxy of the item has changed.
+     * @param item Item information.
+     */
+    bool assign(Utils::ItemInformation *item);
+
+    /**
+     * @brief Releases the proxy used by the item.
+     * @param item Item information.
+     */
+    void release(const Utils::ItemInformation *item);
+
+    /**
+     * @brief Registers a failed or stalled transfer through the proxy of the item.
+     * @param item Item information.
+     */
+    void reportFailure(const Utils::ItemInformation *item);
+
+    /**
+     * @brief Registers the throughput of a transfer through the proxy of the item.
+     * @param item Item information.
+     * @param bytesPerSecond Average speed of the transfer.
+     */
+    void reportThroughput(const Utils::ItemInformation *item, const double bytesPerSecond);
+
+    /**
+     * @brief Parses a proxy in the 'protocol://server:port' format. Returns true on success.
+     * @param text Proxy text.
+     * @param proxy Parsed proxy.
+     */
+    static bool parse(const QString &text, Proxy &proxy);
+
+  public slots:
+    /**
+     * @brief Probes the latency of all the proxies.
+     */
+    void probe();
+
+  private:
+    /**
+     * @brief Probes one proxy, connecting and doing the SOCKS5 greeting if possible.
+     * @param index Index of the proxy.
+     */
+    void probeProxy(const std::size_t index);
+
+    /**
+     * @brief Returns the proxy of the item or nullptr if it is not in the pool.
+     * @param item Item information.
+     */
+    Proxy *find(const Utils::ItemInformation *item);
+
+    /**
+     * @brief Returns the estimated cost of using the proxy, lower is better.
+     * @param proxy Proxy information.
+     */
+    static double cost(const Proxy &proxy);
+
+    std::vector<Proxy> m_proxies; /** proxies of the pool. */
+    QTimer m_timer;               /** probe timer. */
+};
+
+#endif
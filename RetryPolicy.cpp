@@ -0,0 +1,180 @@
+/*
+ File: RetryPolicy.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <RetryPolicy.h>
+
+// Qt
+#include <QSettings>
+#include <QRandomGenerator>
+
+// C++
+#include <algorithm>
+
+const QString RETRY_POLICY_GROUP = "Retry policy";
+const QString MAX_DELAY_KEY = "Maximum delay";
+const QString MAX_THROTTLE_DELAY_KEY = "Maximum throttle delay";
+const QString MAX_FAILURES_KEY = "Maximum failures";
+const QString MAX_HASH_FAILURES_KEY = "Maximum hash failures";
+
+//----------------------------------------------------------------------------
+RetryPolicy::RetryPolicy()
+: m_maxDelay{300}
+, m_maxThrottleDelay{3600}
+, m_maxFailures{0}
+, m_maxHashFailures{3}
+{
+  // errors that will not be solved by retrying the same request.
+  for(const auto code: {1, 2, 3, 4, 9, 19, 37, 43, 48, 53, 54, 58, 59, 61, 63, 66, 67, 68, 69, 77, 78, 94, 98})
+    m_curlCodes.insert(code, Action::PERMANENT);
+
+  for(const auto status: {408, 425, 500, 502, 504})
+    m_httpStatus.insert(status, Action::TRANSIENT);
+
+  for(const auto status: {429, 503})
+    m_httpStatus.insert(status, Action::THROTTLE);
+
+  for(const auto status: {501, 505})
+    m_httpStatus.insert(status, Action::PERMANENT);
+}
+
+//----------------------------------------------------------------------------
+void RetryPolicy::load(QSettings &settings)
+{
+  settings.beginGroup(RETRY_POLICY_GROUP);
+
+  m_maxDelay = settings.value(MAX_DELAY_KEY, m_maxDelay).toUInt();
+  m_maxThrottleDelay = settings.value(MAX_THROTTLE_DELAY_KEY, m_maxThrottleDelay).toUInt();
+  m_maxFailures = settings.value(MAX_FAILURES_KEY, m_maxFailures).toUInt();
+  m_maxHashFailures = settings.value(MAX_HASH_FAILURES_KEY, m_maxHashFailures).toUInt();
+
+  for(const auto &key: settings.childKeys())
+  {
+    const auto parts = key.simplified().split(' ');
+    if(parts.size() != 2) continue;
+
+    bool isValid = false;
+    const auto code = parts.last().toInt(&isValid);
+    Action action;
+    if(!isValid || !fromText(settings.value(key).toString(), action)) continue;
+
+    if(parts.first().compare("curl", Qt::CaseInsensitive) == 0)
+      m_curlCodes.insert(code, action);
+    else if(parts.first().compare("http", Qt::CaseInsensitive) == 0)
+      m_httpStatus.insert(code, action);
+  }
+
+  settings.endGroup();
+}
+
+//----------------------------------------------------------------------------
+RetryPolicy::Action RetryPolicy::classifyCurlCode(const int code) const
+{
+  return m_curlCodes.value(code, Action::TRANSIENT);
+}
+
+//----------------------------------------------------------------------------
+RetryPolicy::Action RetryPolicy::classifyHttpStatus(const int status) const
+{
+  if(m_httpStatus.contains(status))
+    return m_httpStatus.value(status);
+
+  return (status >= 400 && status < 500) ? Action::PERMANENT : Action::TRANSIENT;
+}
+
+//----------------------------------------------------------------------------
+RetryPolicy::Decision RetryPolicy::decide(const int code, const int httpStatus, const int retryAfter, const unsigned int failures, const unsigned int baseDelay) const
+{
+  Decision decision{classifyCurlCode(code), 0, QString()};
+  decision.reason = QString("curl code %1 is %2").arg(code).arg(toText(decision.action));
+
+  if(httpStatus >= 400)
+  {
+    decision.action = classifyHttpStatus(httpStatus);
+    decision.reason = QString("HTTP status %1 is %2").arg(httpStatus).arg(toText(decision.action));
+  }
+
+  auto backoff = [&]()
+  {
+    const auto exponent = std::min(failures > 0 ? failures - 1 : 0, 16u);
+    const auto delay = std::min(static_cast<quint64>(m_maxDelay), static_cast<quint64>(baseDelay) << exponent);
+    // 10% jitter to avoid synchronized retries of several items.
+    const auto jitter = QRandomGenerator::global()->bounded(static_cast<int>(delay / 10) + 1);
+    return std::max(baseDelay, static_cast<unsigned int>(delay) - jitter);
+  };
+
+  switch(decision.action)
+  {
+    case Action::PERMANENT:
+      break;
+    case Action::THROTTLE:
+      if(retryAfter >= 0)
+      {
+        decision.delaySeconds = std::clamp(static_cast<unsigned int>(retryAfter), baseDelay, std::max(baseDelay, m_maxThrottleDelay));
+        decision.reason += QString(", server requested %1 seconds").arg(retryAfter);
+      }
+      else
+        decision.delaySeconds = backoff();
+      break;
+    default:
+    case Action::TRANSIENT:
+      if(m_maxFailures > 0 && failures > m_maxFailures)
+      {
+        decision.action = Action::PERMANENT;
+        decision.reason += QString(", maximum of %1 failures reached").arg(m_maxFailures);
+        break;
+      }
+      decision.delaySeconds = backoff();
+      break;
+  }
+
+  return decision;
+}
+
+//----------------------------------------------------------------------------
+QString RetryPolicy::toText(const Action action)
+{
+  switch(action)
+  {
+    case Action::THROTTLE:
+      return "throttle";
+    case Action::PERMANENT:
+      return "permanent";
+    default:
+    case Action::TRANSIENT:
+      break;
+  }
+
+  return "transient";
+}
+
+//----------------------------------------------------------------------------
+bool RetryPolicy::fromText(const QString &text, Action &action)
+{
+  for(const auto value: {Action::TRANSIENT, Action::THROTTLE, Action::PERMANENT})
+  {
+    if(text.trimmed().compare(toText(value), Qt::CaseInsensitive) == 0)
+    {
+      action = value;
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,119 @@
+/*
+ File: RetryPolicy.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RETRY_POLICY_H_
+#define _RETRY_POLICY_H_
+
+// Qt
+#include <QMap>
+#include <QString>
+
+class QSettings;
+
+/**
+ * @brief Classifies the curl exit codes and HTTP status codes of a failed attempt and
+ * decides if and when the download must be retried.
+ */
+class RetryPolicy
+{
+  public:
+    /**
+     * @brief Error classes.
+     */
+    enum class Action: char
+    {
+      TRANSIENT = 0, /** retry with exponential backoff. */
+      THROTTLE = 1,  /** retry honoring the Retry-After header of the server. */
+      PERMANENT = 2  /** do not retry. */
+    };
+
+    /**
+     * @brief Retry decision.
+     */
+    struct Decision
+    {
+      Action action;             /** error class. */
+      unsigned int delaySeconds; /** seconds to wait before retrying. */
+      QString reason;            /** text explaining the decision. */
+    };
+
+    /**
+     * @brief RetryPolicy class constructor. Initializes the default classification table.
+     */
+    RetryPolicy();
+
+    /**
+     * @brief Loads the overrides of the classification table and the delays from the settings.
+     * The table entries are stored in the "Retry policy" group as "curl <code>" or "http <status>"
+     * keys with "transient", "throttle" or "permanent" values.
+     * @param settings Application settings.
+     */
+    void load(QSettings &settings);
+
+    /**
+     * @brief Returns the class of the given curl exit code.
+     * @param code curl exit code.
+     */
+    Action classifyCurlCode(const int code) const;
+
+    /**
+     * @brief Returns the class of the given HTTP status code.
+     * @param status HTTP status code.
+     */
+    Action classifyHttpStatus(const int status) const;
+
+    /**
+     * @brief Returns the retry decision for a failed attempt.
+     * @param code curl exit code.
+     * @param httpStatus HTTP status of the last response or 0 if unknown.
+     * @param retryAfter Seconds requested by the server in the Retry-After header or -1 if not present.
+     * @param failures Number of consecutive failed attempts, including this one.
+     * @param baseDelay Minimum delay in seconds.
+     */
+    Decision decide(const int code, const int httpStatus, const int retryAfter, const unsigned int failures, const unsigned int baseDelay) const;
+
+    /**
+     * @brief Returns the text of the given action.
+     * @param action Action value.
+     */
+    static QString toText(const Action action);
+
+    /**
+     * @brief Returns the number of downloads that don't match the hashes before failing, 0 for no limit.
+     */
+    unsigned int maxHashFailures() const
+    { return m_maxHashFailures; }
+
+  private:
+    /**
+     * @brief Parses the given text as an action. Returns true on success.
+     * @param text Action text.
+     * @param action Parsed action.
+     */
+    static bool fromText(const QString &text, Action &action);
+
+    QMap<int, Action> m_curlCodes;    /** curl exit code classes, missing codes are transient. */
+    QMap<int, Action> m_httpStatus;   /** HTTP status classes, missing codes are classified by range. */
+    unsigned int m_maxDelay;          /** maximum backoff delay in seconds. */
+    unsigned int m_maxThrottleDelay;  /** maximum delay accepted from the Retry-After header in seconds. */
+    unsigned int m_maxFailures;       /** maximum number of consecutive transient failures, 0 for no limit. */
+    unsigned int m_maxHashFailures;   /** maximum number of downloads that don't match the hashes, 0 for no limit. */
+};
+
+#endif
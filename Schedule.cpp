@@ -0,0 +1,140 @@
+/*
+ File: Schedule.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Schedule.h>
+
+const QStringList DAYS = {"mon", "tue", "wed", "thu", "fri", "sat", "sun"};
+
+namespace
+{
+  /**
+   * @brief Parses a 'hh:mm' time as minutes of the day, '24:00' is the end of the day. Returns
+   * false if not valid.
+   * @param text Time text.
+   * @param minute Minute of the day.
+   */
+  bool parseMinute(const QString &text, int &minute)
+  {
+    const auto parts = text.split(':');
+    if(parts.size() != 2) return false;
+
+    bool validHour = false, validMinute = false;
+    const auto hours = parts.at(0).toInt(&validHour);
+    const auto minutes = parts.at(1).toInt(&validMinute);
+    if(!validHour || !validMinute || hours < 0 || hours > 24 || minutes < 0 || minutes > 59 || (hours == 24 && minutes != 0))
+      return false;
+
+    minute = hours * 60 + minutes;
+    return true;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool Schedule::Rule::matches(const QDateTime &time) const
+{
+  const auto minute = time.time().hour() * 60 + time.time().minute();
+  const auto day = time.date().dayOfWeek() - 1;
+  const auto previous = (day + 6) % 7;
+  const auto isDay = [this](const int d) { return (days & (1 << d)) != 0; };
+
+  if(start < end)
+    return isDay(day) && minute >= start && minute < end;
+
+  // the part after midnight belongs to the day the window started.
+  return (isDay(day) && minute >= start) || (isDay(previous) && minute < end);
+}
+
+//----------------------------------------------------------------------------
+void Schedule::setRules(const QStringList &rules)
+{
+  m_rules.clear();
+
+  for(const auto &text: rules)
+  {
+    Rule rule;
+    if(parse(text, rule))
+      m_rules.push_back(rule);
+  }
+}
+
+//----------------------------------------------------------------------------
+int Schedule::activeRule(const QDateTime &time) const
+{
+  for(int i = 0; i < static_cast<int>(m_rules.size()); ++i)
+  {
+    if(m_rules.at(i).matches(time)) return i;
+  }
+
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+bool Schedule::parse(const QString &text, Rule &rule)
+{
+  const auto parts = text.simplified().split(' ', Qt::SkipEmptyParts);
+  if(parts.size() < 2) return false;
+
+  rule = Rule();
+  rule.text = text.simplified();
+
+  for(const auto &days: parts.at(0).toLower().split(','))
+  {
+    if(days == "daily" || days == "*")
+    {
+      rule.days = 0x7F;
+      continue;
+    }
+
+    // ranges can wrap around the end of the week, 'fri-mon'.
+    const auto range = days.split('-');
+    const auto first = DAYS.indexOf(range.first());
+    const auto last = DAYS.indexOf(range.last());
+    if(range.size() > 2 || first == -1 || last == -1) return false;
+
+    for(auto day = first; ; day = (day + 1) % 7)
+    {
+      rule.days |= (1 << day);
+      if(day == last) break;
+    }
+  }
+
+  const auto window = parts.at(1).split('-');
+  if(window.size() != 2 || !parseMinute(window.at(0), rule.start) || !parseMinute(window.at(1), rule.end) || rule.start == rule.end)
+    return false;
+
+  for(int i = 2; i < parts.size(); ++i)
+  {
+    const auto option = parts.at(i).toLower();
+    bool valid = true;
+
+    if(option == "pause")
+      rule.pauseNonUrgent = true;
+    else if(option.startsWith("rate="))
+      rule.rateLimit = option.mid(5).toUInt(&valid);
+    else if(option.startsWith("active="))
+      rule.maxActive = option.mid(7).toUInt(&valid);
+    else
+      valid = false;
+
+    if(!valid) return false;
+  }
+
+  return true;
+}
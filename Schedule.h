@@ -0,0 +1,97 @@
+/*
+ File: Schedule.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SCHEDULE_H_
+#define _SCHEDULE_H_
+
+// Qt
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+
+// C++
+#include <vector>
+
+/**
+ * @brief Time of day and weekday rules that change the global rate limit and the maximum active
+ * downloads, and can pause the items without high priority. Each rule is a line with the format
+ * '<days> <hh:mm>-<hh:mm> [rate=<KB/s>] [active=<count>] [pause]', where the days are 'daily' or
+ * a comma separated list of days ('mon') and ranges of days ('mon-fri'). A window that ends before
+ * it starts ends the next day. The first rule that matches the time applies.
+ */
+class Schedule
+{
+  public:
+    /**
+     * @brief Schedule rule.
+     */
+    struct Rule
+    {
+      unsigned char days = 0;      /** days of the rule, bit 0 is monday and bit 6 is sunday. */
+      int start = 0;               /** minute of the day the window starts. */
+      int end = 0;                 /** minute of the day the window ends, before the start if it ends the next day. */
+      unsigned int rateLimit = 0;  /** global rate limit in KB/s, 0 for no limit. */
+      unsigned int maxActive = 0;  /** maximum active downloads, 0 for the configured value. */
+      bool pauseNonUrgent = false; /** true to pause the items without high priority. */
+      QString text;                /** rule text. */
+
+      /**
+       * @brief Returns true if the time is inside the window of the rule.
+       * @param time Date and time.
+       */
+      bool matches(const QDateTime &time) const;
+    };
+
+    /**
+     * @brief Sets the rules, the invalid ones are ignored.
+     * @param rules Rules texts.
+     */
+    void setRules(const QStringList &rules);
+
+    /**
+     * @brief Returns the index of the rule that applies at the given time or -1 if none.
+     * @param time Date and time.
+     */
+    int activeRule(const QDateTime &time) const;
+
+    /**
+     * @brief Returns the rule with the given index.
+     * @param index Rule index.
+     */
+    const Rule &rule(const int index) const
+    { return m_rules.at(index); }
+
+    /**
+     * @brief Returns true if there are no rules.
+     */
+    bool isEmpty() const
+    { return m_rules.empty(); }
+
+    /**
+     * @brief Parses a rule. Returns false if the text is not valid.
+     * @param text Rule text.
+     * @param rule Rule information.
+     */
+    static bool parse(const QString &text, Rule &rule);
+
+  private:
+    std::vector<Rule> m_rules; /** rules in order of precedence. */
+};
+
+#endif
@@ -0,0 +1,806 @@
+/*
+ File: SegmentedDownload.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <SegmentedDownload.h>
+#include <Metrics.h>
+#include <Checksums.h>
+#include <ProcessLimits.h>
+
+// Qt
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+
+// C++
+#include <algorithm>
+#include <memory>
+
+const int MAX_HEADERS_SIZE = 64 * 1024;
+const unsigned int MAX_PROBE_FAILURES = 3; // consecutive attempts with unanswered probes before downloading from the url.
+
+//----------------------------------------------------------------------------
+SegmentedDownload::SegmentedDownload(const Utils::Configuration &config, Utils::ItemInformation *item, ConnectionLimiter *limiter, QObject *parent)
+: QObject(parent)
+, m_config{config}
+, m_item{item}
+, m_limiter{limiter}
+, m_running{false}
+, m_totalSize{0}
+, m_lastDownloaded{0}
+, m_speed{0}
+, m_maxConnections{std::max(1u, config.maxSegments)}
+, m_rateLimit{0}
+, m_lastError{0}
+, m_ticks{0}
+, m_generation{0}
+, m_preallocated{false}
+, m_probeFailures{0}
+{
+  m_timer.setInterval(1000);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTick()));
+}
+
+//----------------------------------------------------------------------------
+SegmentedDownload::~SegmentedDownload()
+{
+  if(m_running)
+  {
+    m_timer.stop();
+    killProcesses();
+    if(m_file.isOpen()) m_file.close();
+    saveState();
+  }
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::start()
+{
+  if(m_running) return;
+
+  m_sources.clear();
+  for(const auto &url: QList<QUrl>{m_item->url} + m_item->mirrors)
+  {
+    Source source;
+    source.url = url;
+    m_sources.push_back(source);
+  }
+
+  m_ranges.clear();
+  m_running = true;
+  m_totalSize = 0;
+  m_lastDownloaded = 0;
+  m_speed = 0;
+  m_lastError = 0;
+  m_ticks = 0;
+
+  probeSources();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::stop()
+{
+  if(!m_running) return;
+
+  // CURLE_ABORTED_BY_CALLBACK, same as a killed curl process.
+  finish(42);
+}
+
+//----------------------------------------------------------------------------
+qint64 SegmentedDownload::downloadedBytes() const
+{
+  qint64 result = 0;
+  for(const auto &range: m_ranges)
+    result += range.written;
+
+  return result;
+}
+
+//----------------------------------------------------------------------------
+int SegmentedDownload::activeConnections() const
+{
+  return std::count_if(m_ranges.cbegin(), m_ranges.cend(), [](const Range &r) { return r.process != nullptr; });
+}
+
+//----------------------------------------------------------------------------
+QList<qint64> SegmentedDownload::processIds() const
+{
+  QList<qint64> pids;
+  for(const auto &source: m_sources)
+    if(source.probe) pids << source.probe->processId();
+
+  for(const auto &range: m_ranges)
+    if(range.process) pids << range.process->processId();
+
+  return pids;
+}
+
+//----------------------------------------------------------------------------
+int SegmentedDownload::validSources() const
+{
+  return std::count_if(m_sources.cbegin(), m_sources.cend(), [](const Source &s) { return s.valid; });
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::setMaxConnections(const unsigned int connections)
+{
+  m_maxConnections = std::max(1u, connections);
+  schedule();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::removeState()
+{
+  m_ranges.clear();
+  m_preallocated = false;
+  QFile::remove(stateFile());
+}
+
+//----------------------------------------------------------------------------
+bool SegmentedDownload::hasPartialFile() const
+{
+  return m_preallocated || QFile::exists(stateFile());
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::probeSources()
+{
+  for(auto &source: m_sources)
+  {
+    auto process = new QProcess(this);
+    process->setWorkingDirectory(m_config.downloadPath);
+    process->setProgram(m_config.curlPath);
+    ProcessLimits::apply(*process, m_config);
+    process->setArguments(baseArguments() << "--head" << "--url" << source.url.toString());
+    connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProbeFinished(int, QProcess::ExitStatus)));
+
+    source.probe = process;
+    process->start();
+    if(!process->waitForStarted())
+    {
+      emit message(QString("Unable to start the probe of '%1'.\n").arg(source.url.toString()));
+      source.probe = nullptr;
+      // CURLE_FAILED_INIT
+      source.probeError = 2;
+      process->deleteLater();
+      continue;
+    }
+
+    emit processStarted();
+  }
+
+  auto isProbing = [](const Source &s) { return s.probe != nullptr; };
+  if(std::none_of(m_sources.cbegin(), m_sources.cend(), isProbing))
+    onProbesDone();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::onProbeFinished(int code, QProcess::ExitStatus)
+{
+  auto it = std::find_if(m_sources.begin(), m_sources.end(), [this](const Source &s) { return s.probe == sender(); });
+  if(it == m_sources.end()) return;
+
+  const auto headers = Utils::parseResponseHeaders(it->probe->readAllStandardOutput());
+  it->probe->deleteLater();
+  it->probe = nullptr;
+  it->probeError = 0;
+
+  if(code == 0 && headers.status == 200)
+  {
+    it->size = headers.headers.value("content-length").toLongLong();
+    it->validator = headers.validator();
+    it->ranges = headers.headers.value("accept-ranges").compare("bytes", Qt::CaseInsensitive) == 0;
+  }
+  else
+  {
+    // connection errors and server errors are not an answer about the ranges. CURLE_HTTP_RETURNED_ERROR
+    // for the server errors.
+    if(code != 0 || headers.status == 0 || headers.status >= 500)
+      it->probeError = (code != 0) ? code : 22;
+
+    emit message(QString("Probe of '%1' failed with code %2 and HTTP status %3.\n").arg(it->url.toString()).arg(code).arg(headers.status));
+  }
+
+  auto isProbing = [](const Source &s) { return s.probe != nullptr; };
+  if(std::none_of(m_sources.cbegin(), m_sources.cend(), isProbing))
+    onProbesDone();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::onProbesDone()
+{
+  if(!m_running) return;
+
+  // the url of the item is the reference, or the first mirror that answered if it didn't. The size
+  // of the manifest, if any, must match.
+  const auto expectedSize = m_item->size;
+  auto isReference = [expectedSize](const Source &s) { return s.size > 0 && (expectedSize <= 0 || s.size == expectedSize); };
+  auto reference = std::find_if(m_sources.cbegin(), m_sources.cend(), isReference);
+  if(reference == m_sources.cend() || std::none_of(m_sources.cbegin(), m_sources.cend(), [](const Source &s) { return s.ranges; }))
+  {
+    // a source that didn't answer may accept ranges, the attempt is retried. Only if the sources keep
+    // failing and the rest answered the file is downloaded from the url.
+    auto failed = std::find_if(m_sources.cbegin(), m_sources.cend(), [](const Source &s) { return s.probeError != 0; });
+    const auto answered = std::any_of(m_sources.cbegin(), m_sources.cend(), [](const Source &s) { return s.probeError == 0; });
+    if(failed != m_sources.cend() && (!answered || ++m_probeFailures < MAX_PROBE_FAILURES))
+    {
+      emit message("Some sources didn't answer the probe, retrying the download by ranges.\n");
+      finish(failed->probeError);
+      return;
+    }
+
+    m_probeFailures = 0;
+    emit message("No source reported the size of the file and support of ranges, downloading from the url.\n");
+    m_running = false;
+    emit unsupported();
+    return;
+  }
+
+  m_probeFailures = 0;
+  m_totalSize = reference->size;
+  const auto validator = reference->validator;
+
+  if(!m_item->validator.isEmpty() && !validator.isEmpty() && validator != m_item->validator)
+  {
+    emit message("The remote file has changed, restarting from the beginning.\n");
+    Metrics::add("wasted bytes", QFileInfo(temporalFile()).size());
+    QFile::remove(temporalFile());
+    QFile::remove(stateFile());
+  }
+  m_item->validator = validator;
+
+  for(auto &source: m_sources)
+  {
+    source.valid = source.ranges && source.size == m_totalSize && (source.validator.isEmpty() || validator.isEmpty() || source.validator == validator);
+
+    if(!source.valid && source.size > 0)
+      emit message(QString("Ignoring source '%1': %2.\n").arg(source.url.toString())
+                     .arg(!source.ranges ? "doesn't accept ranges" : (source.size != m_totalSize ? "different size" : "different validator")));
+  }
+
+  // after a failure only the pieces that don't match are downloaded again.
+  if(!m_item->hashes.pieces.isEmpty() && QFileInfo(temporalFile()).size() == m_totalSize)
+  {
+    verifyPieces();
+    return;
+  }
+
+  startTransfer(std::vector<bool>());
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::verifyPieces()
+{
+  emit message("Verifying the pieces of the temporal file...\n");
+
+  const auto generation = m_generation;
+  auto result = std::make_shared<Checksums::Result>();
+  auto thread = QThread::create([result, filename = temporalFile(), hashes = m_item->hashes]()
+  {
+    *result = Checksums::verify(filename, hashes, false);
+  });
+
+  connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+  connect(thread, &QThread::finished, this, [this, result, generation]()
+  {
+    if(!m_running || generation != m_generation) return;
+
+    if(!result->valid || result->pieces.empty())
+    {
+      startTransfer(std::vector<bool>());
+      return;
+    }
+
+    const auto badPieces = result->badPieces();
+    Metrics::add("pieces refetched", badPieces);
+    emit message(QString("%1 of %2 pieces don't match and will be downloaded again.\n").arg(badPieces).arg(result->pieces.size()));
+
+    startTransfer(result->pieces);
+  });
+
+  thread->start();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::startTransfer(const std::vector<bool> &pieces)
+{
+  if(!prepareRanges(pieces))
+  {
+    emit message(QString("Unable to prepare the temporal file '%1'.\n").arg(QDir::toNativeSeparators(temporalFile())));
+    // CURLE_WRITE_ERROR
+    finish(23);
+    return;
+  }
+
+  emit message(QString("Downloading %1 bytes in %2 ranges from %3 sources.\n").arg(m_totalSize).arg(m_ranges.size()).arg(validSources()));
+
+  m_lastDownloaded = downloadedBytes();
+  m_timer.start();
+  schedule();
+  checkCompletion();
+}
+
+//----------------------------------------------------------------------------
+bool SegmentedDownload::prepareRanges(const std::vector<bool> &pieces)
+{
+  m_ranges.clear();
+  m_file.setFileName(temporalFile());
+
+  // consecutive pieces with the same result form a range.
+  const auto pieceLength = m_item->hashes.pieceLength;
+  for(std::size_t i = 0, j = 0; i < pieces.size(); i = j)
+  {
+    while(j < pieces.size() && pieces.at(j) == pieces.at(i)) ++j;
+
+    Range range;
+    range.start = static_cast<qint64>(i) * pieceLength;
+    range.end = std::min(static_cast<qint64>(j) * pieceLength, m_totalSize) - 1;
+    range.written = pieces.at(i) ? range.end - range.start + 1 : 0;
+    m_ranges.push_back(range);
+  }
+
+  QFile state(stateFile());
+  if(m_ranges.empty() && m_file.exists() && m_file.size() == m_totalSize && state.open(QIODevice::ReadOnly))
+  {
+    const auto object = QJsonDocument::fromJson(state.readAll()).object();
+    if(object.value("size").toInteger() == m_totalSize && object.value("validator").toString() == m_item->validator)
+    {
+      for(const auto value: object.value("ranges").toArray())
+      {
+        const auto values = value.toArray();
+        Range range;
+        range.start = values.at(0).toInteger();
+        range.end = values.at(1).toInteger();
+        range.written = std::clamp(values.at(2).toInteger(), static_cast<qint64>(0), range.end - range.start + 1);
+        m_ranges.push_back(range);
+      }
+    }
+  }
+
+  if(m_ranges.empty())
+  {
+    // a temporal file without state comes from a single transfer, its contents are the start of the file.
+    const auto existing = (m_file.exists() && m_file.size() < m_totalSize) ? m_file.size() : 0;
+    if(existing > 0)
+    {
+      Range range;
+      range.start = 0;
+      range.end = existing - 1;
+      range.written = existing;
+      m_ranges.push_back(range);
+    }
+
+    const qint64 minimum = std::max(1u, m_config.minSegmentSize) * 1024;
+    const qint64 remaining = m_totalSize - existing;
+    const qint64 count = std::clamp(remaining / minimum, static_cast<qint64>(1), static_cast<qint64>(std::min(m_maxConnections, static_cast<unsigned int>(std::max(1, validSources())))));
+    const qint64 length = remaining / count;
+    for(qint64 i = 0; i < count; ++i)
+    {
+      Range range;
+      range.start = existing + i * length;
+      range.end = (i == count - 1) ? m_totalSize - 1 : range.start + length - 1;
+      m_ranges.push_back(range);
+    }
+  }
+
+  if(!m_file.open(QIODevice::ReadWrite))
+    return false;
+
+  m_preallocated = m_file.size() == m_totalSize || m_file.resize(m_totalSize);
+  return m_preallocated;
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::schedule()
+{
+  while(m_running && m_totalSize > 0 && activeConnections() < static_cast<int>(m_maxConnections))
+  {
+    const auto sources = validSources();
+    if(sources == 0) return;
+    const auto perSource = (static_cast<int>(m_maxConnections) + sources - 1) / sources;
+
+    // the least used source, the fastest one in case of a tie.
+    int source = -1;
+    for(int i = 0; i < static_cast<int>(m_sources.size()); ++i)
+    {
+      const auto &candidate = m_sources.at(i);
+      if(!candidate.valid || candidate.connections >= perSource) continue;
+      if(m_limiter && !m_limiter->canOpen(candidate.url, m_item)) continue;
+      if(source == -1 || candidate.connections < m_sources.at(source).connections ||
+         (candidate.connections == m_sources.at(source).connections && candidate.speed > m_sources.at(source).speed))
+        source = i;
+    }
+    if(source == -1) return;
+
+    auto isPending = [](const Range &r) { return r.process == nullptr && r.remaining() > 0; };
+    auto it = std::find_if(m_ranges.cbegin(), m_ranges.cend(), isPending);
+    const auto range = (it != m_ranges.cend()) ? static_cast<int>(std::distance(m_ranges.cbegin(), it)) : splitLargestRange(source);
+    if(range == -1) return;
+
+    startRange(range, source);
+  }
+}
+
+//----------------------------------------------------------------------------
+int SegmentedDownload::splitLargestRange(const int source)
+{
+  int largest = -1;
+  for(int i = 0; i < static_cast<int>(m_ranges.size()); ++i)
+  {
+    if(m_ranges.at(i).process && (largest == -1 || m_ranges.at(i).remaining() > m_ranges.at(largest).remaining()))
+      largest = i;
+  }
+
+  const qint64 minimum = std::max(1u, m_config.minSegmentSize) * 1024;
+  if(largest == -1 || m_ranges.at(largest).remaining() < 2 * minimum)
+    return -1;
+
+  // the new source takes a part proportional to its speed, half if any of them is unknown.
+  const auto ownerSpeed = m_sources.at(m_ranges.at(largest).source).speed;
+  const auto sourceSpeed = m_sources.at(source).speed;
+  const auto share = (ownerSpeed > 0 && sourceSpeed > 0) ? std::clamp(sourceSpeed / (ownerSpeed + sourceSpeed), 0.1, 0.9) : 0.5;
+
+  const auto remaining = m_ranges.at(largest).remaining();
+  const auto length = std::clamp(static_cast<qint64>(remaining * share), minimum, remaining - minimum);
+
+  // the process of the split range stops when it reaches its new end.
+  Range range;
+  range.end = m_ranges.at(largest).end;
+  range.start = range.end - length + 1;
+  m_ranges.at(largest).end = range.start - 1;
+  m_ranges.push_back(range);
+
+  Metrics::add("range splits", 1);
+  return static_cast<int>(m_ranges.size()) - 1;
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::startRange(const int rangeIndex, const int sourceIndex)
+{
+  auto &range = m_ranges.at(rangeIndex);
+  auto &source = m_sources.at(sourceIndex);
+
+  QStringList arguments = baseArguments();
+  arguments << "--fail"; // Don't write error pages in the file.
+  arguments << "--include"; // Response headers in stdout before the body, to verify the range.
+  arguments << "--range" << QString("%1-%2").arg(range.start + range.written).arg(range.end);
+  if(m_rateLimit > 0)
+    arguments << "--limit-rate" << QString::number(std::max(static_cast<qint64>(1024), m_rateLimit / m_maxConnections));
+  if(!m_item->validator.isEmpty())
+    arguments << "--header" << "If-Range: " + m_item->validator;
+  arguments << "--url" << source.url.toString();
+
+  auto process = new QProcess(this);
+  process->setWorkingDirectory(m_config.downloadPath);
+  process->setProgram(m_config.curlPath);
+  ProcessLimits::apply(*process, m_config);
+  process->setArguments(arguments);
+  connect(process, SIGNAL(readyReadStandardOutput()), this, SLOT(onRangeData()));
+  connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onRangeFinished(int, QProcess::ExitStatus)));
+
+  range.source = sourceIndex;
+  range.process = process;
+  range.inBody = false;
+  range.buffer.clear();
+  if(m_limiter) range.connection = m_limiter->open(source.url, m_item);
+  ++source.connections;
+  m_lastArguments = arguments;
+
+  process->start();
+  if(!process->waitForStarted())
+  {
+    emit message("Unable to start the curl process.\n");
+    range.process = nullptr;
+    range.source = -1;
+    closeConnection(range);
+    --source.connections;
+    process->deleteLater();
+    // CURLE_FAILED_INIT
+    finish(2);
+    return;
+  }
+
+  emit processStarted();
+}
+
+//----------------------------------------------------------------------------
+bool SegmentedDownload::parseRangeHeaders(Range &range)
+{
+  while(!range.inBody)
+  {
+    const auto end = range.buffer.indexOf("\r\n\r\n");
+    if(end == -1)
+      return range.buffer.size() < MAX_HEADERS_SIZE;
+
+    const auto headers = Utils::parseResponseHeaders(range.buffer.left(end));
+    range.buffer.remove(0, end + 4);
+
+    // informational responses and redirects followed by curl.
+    if((headers.status >= 100 && headers.status < 200) || (headers.status >= 300 && headers.status < 400))
+      continue;
+
+    // 'Content-Range: bytes <first>-<last>/<size>'
+    const auto contentRange = headers.headers.value("content-range");
+    const auto expected = QString("bytes %1-").arg(range.start + range.written);
+    if(headers.status != 206 || !contentRange.startsWith(expected) || !contentRange.endsWith(QString("/%1").arg(m_totalSize)))
+      return false;
+
+    range.inBody = true;
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::onRangeData()
+{
+  const auto index = findRange(sender());
+  if(index == -1) return;
+
+  auto &range = m_ranges.at(index);
+  auto data = range.process->readAllStandardOutput();
+
+  if(!range.inBody)
+  {
+    range.buffer += data;
+    if(!parseRangeHeaders(range))
+    {
+      // the source ignores ranges or the file has changed, nothing it sends can be used.
+      auto &source = m_sources.at(range.source);
+      emit message(QString("Source '%1' didn't send the requested range, dropping it.\n").arg(source.url.toString()));
+      source.valid = false;
+      range.process->kill();
+      return;
+    }
+
+    if(!range.inBody) return;
+
+    data = range.buffer;
+    range.buffer.clear();
+  }
+
+  const auto count = std::min(static_cast<qint64>(data.size()), range.remaining());
+  if(count > 0)
+  {
+    if(!m_file.seek(range.start + range.written) || m_file.write(data.constData(), count) != count)
+    {
+      emit message(QString("Unable to write in '%1': %2\n").arg(QDir::toNativeSeparators(temporalFile())).arg(m_file.errorString()));
+      // CURLE_WRITE_ERROR
+      finish(23);
+      return;
+    }
+
+    range.written += count;
+    m_sources.at(range.source).bytes += count;
+  }
+
+  // reached the end of the range, possibly shortened by a split.
+  if(range.remaining() == 0)
+    range.process->kill();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::onRangeFinished(int code, QProcess::ExitStatus)
+{
+  const auto index = findRange(sender());
+  if(index == -1) return;
+
+  auto &range = m_ranges.at(index);
+  auto &source = m_sources.at(range.source);
+  const auto errorText = QString(range.process->readAllStandardError()).trimmed();
+
+  range.process->deleteLater();
+  range.process = nullptr;
+  range.source = -1;
+  range.inBody = false;
+  range.buffer.clear();
+  closeConnection(range);
+  --source.connections;
+
+  if(range.remaining() > 0)
+  {
+    ++source.errors;
+    // CURLE_RECV_ERROR if the server closed the connection without error.
+    m_lastError = (code != 0) ? code : 56;
+
+    emit message(QString("Range from '%1' failed with code %2%3.\n").arg(source.url.toString()).arg(code)
+                   .arg(errorText.isEmpty() ? QString() : ": " + errorText));
+
+    if(source.valid && source.errors >= std::max(1u, m_config.maxSourceErrors))
+    {
+      source.valid = false;
+      Metrics::add("dropped mirrors", 1);
+      emit message(QString("Dropping source '%1' after %2 errors.\n").arg(source.url.toString()).arg(source.errors));
+    }
+  }
+  else
+  {
+    source.errors = 0;
+  }
+
+  schedule();
+  checkCompletion();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::onTick()
+{
+  auto average = [](const double previous, const double value) { return previous == 0 ? value : 0.7 * previous + 0.3 * value; };
+
+  for(auto &source: m_sources)
+  {
+    source.speed = average(source.speed, source.bytes - source.lastBytes);
+    source.lastBytes = source.bytes;
+  }
+
+  const auto downloaded = downloadedBytes();
+  m_speed = average(m_speed, downloaded - m_lastDownloaded);
+  m_lastDownloaded = downloaded;
+
+  emit progress(downloaded, m_totalSize, static_cast<qint64>(m_speed));
+
+  if(++m_ticks % 5 == 0)
+  {
+    m_file.flush();
+    saveState();
+  }
+
+  // connections closed by other items can be used now.
+  schedule();
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::closeConnection(Range &range)
+{
+  if(m_limiter) m_limiter->close(range.connection);
+}
+
+//----------------------------------------------------------------------------
+int SegmentedDownload::findRange(const QObject *process) const
+{
+  auto it = std::find_if(m_ranges.cbegin(), m_ranges.cend(), [process](const Range &r) { return r.process == process; });
+  return it == m_ranges.cend() ? -1 : static_cast<int>(std::distance(m_ranges.cbegin(), it));
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::checkCompletion()
+{
+  if(!m_running || m_totalSize == 0) return;
+
+  if(std::all_of(m_ranges.cbegin(), m_ranges.cend(), [](const Range &r) { return r.remaining() == 0; }))
+  {
+    emit progress(m_totalSize, m_totalSize, static_cast<qint64>(m_speed));
+    finish(0);
+    return;
+  }
+
+  if(activeConnections() == 0 && validSources() == 0)
+  {
+    emit message("No usable sources left.\n");
+    // CURLE_COULDNT_CONNECT if no range was even tried.
+    finish(m_lastError != 0 ? m_lastError : 7);
+  }
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::finish(const int code)
+{
+  if(!m_running) return;
+  m_running = false;
+  ++m_generation;
+
+  m_timer.stop();
+  killProcesses();
+
+  if(m_file.isOpen())
+  {
+    m_file.flush();
+    m_file.close();
+  }
+
+  if(code == 0)
+    removeState();
+  else
+    saveState();
+
+  emit finished(code);
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::killProcesses()
+{
+  auto kill = [this](QProcess *process)
+  {
+    disconnect(process, nullptr, this, nullptr);
+    process->kill();
+    process->waitForFinished();
+    process->deleteLater();
+  };
+
+  for(auto &source: m_sources)
+  {
+    if(source.probe) kill(source.probe);
+    source.probe = nullptr;
+    source.connections = 0;
+  }
+
+  for(auto &range: m_ranges)
+  {
+    if(range.process) kill(range.process);
+    range.process = nullptr;
+    range.source = -1;
+    closeConnection(range);
+    range.inBody = false;
+    range.buffer.clear();
+  }
+}
+
+//----------------------------------------------------------------------------
+void SegmentedDownload::saveState() const
+{
+  if(m_ranges.empty() || m_totalSize == 0) return;
+
+  QJsonArray ranges;
+  for(const auto &range: m_ranges)
+  {
+    if(range.end >= range.start)
+      ranges.append(QJsonArray{range.start, range.end, range.written});
+  }
+
+  QJsonObject object;
+  object.insert("url", m_item->url.toString());
+  object.insert("size", m_totalSize);
+  object.insert("validator", m_item->validator);
+  object.insert("ranges", ranges);
+
+  QDir().mkpath(m_config.metadataFolder());
+  QFile file(stateFile());
+  if(file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+}
+
+//----------------------------------------------------------------------------
+QStringList SegmentedDownload::baseArguments() const
+{
+  QStringList arguments;
+  arguments << "--disable"; // Disable .curlrc
+  arguments << "--connect-timeout" << "60"; // Maximum time allowed for connection
+  arguments << "--insecure"; // Allow insecure server connections when using SSL
+  arguments << "--location"; // Follow redirects
+  arguments << "--silent" << "--show-error"; // No progress meter, the progress is computed from the written bytes.
+  arguments << "--globoff"; // Switch off the URL globbing function, parses urls with {}[] chars.
+  arguments << Utils::curlProxyArguments(*m_item);
+
+  return arguments;
+}
+
+//----------------------------------------------------------------------------
+QString SegmentedDownload::stateFile() const
+{
+  return QDir(m_config.metadataFolder()).absoluteFilePath(m_item->outputName + ".ranges");
+}
+
+//----------------------------------------------------------------------------
+QString SegmentedDownload::temporalFile() const
+{
+  return QDir(m_config.downloadPath).absoluteFilePath(m_item->outputName + m_config.extension);
+}
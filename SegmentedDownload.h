@@ -0,0 +1,356 @@
+/*
+ File: SegmentedDownload.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SEGMENTED_DOWNLOAD_H_
+#define _SEGMENTED_DOWNLOAD_H_
+
+// Project
+#include <Utils.h>
+#include <ConnectionLimiter.h>
+
+// Qt
+#include <QObject>
+#include <QProcess>
+#include <QFile>
+#include <QTimer>
+
+// C++
+#include <vector>
+
+/**
+ * @brief Downloads an item from its url and mirrors at the same time, one curl process per
+ * byte range, writing all the ranges into the temporal file. The mirrors are verified with a
+ * HEAD request, idle mirrors take part of the largest remaining range in proportion to their
+ * speed and mirrors that fail repeatedly are dropped.
+ */
+class SegmentedDownload
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /**
+     * @brief SegmentedDownload class constructor.
+     * @param config Application configuration struct reference.
+     * @param item Item information, with at least one mirror.
+     * @param limiter Connections limiter or nullptr for no limits.
+     * @param parent Raw pointer of the object parent of this one.
+     */
+    SegmentedDownload(const Utils::Configuration &config, Utils::ItemInformation *item, ConnectionLimiter *limiter = nullptr, QObject *parent = nullptr);
+
+    /**
+     * @brief SegmentedDownload class virtual destructor.
+     */
+    virtual ~SegmentedDownload();
+
+    /**
+     * @brief Probes the sources and starts the transfer of the remaining ranges.
+     */
+    void start();
+
+    /**
+     * @brief Stops all the processes and stores the state of the ranges. Emits finished()
+     * if the transfer was running.
+     */
+    void stop();
+
+    /**
+     * @brief Returns true if the sources are being probed or the ranges downloaded.
+     */
+    bool isRunning() const
+    { return m_running; }
+
+    /**
+     * @brief Returns the size of the file or 0 if unknown.
+     */
+    qint64 totalSize() const
+    { return m_totalSize; }
+
+    /**
+     * @brief Returns the number of bytes of the file already downloaded.
+     */
+    qint64 downloadedBytes() const;
+
+    /**
+     * @brief Returns the number of running curl processes.
+     */
+    int activeConnections() const;
+
+    /**
+     * @brief Returns the process identifiers of the running curl processes, probes included.
+     */
+    QList<qint64> processIds() const;
+
+    /**
+     * @brief Returns the number of usable sources.
+     */
+    int validSources() const;
+
+    /**
+     * @brief Sets the maximum number of simultaneous ranges.
+     * @param connections Number of connections, at least 1.
+     */
+    void setMaxConnections(const unsigned int connections);
+
+    /**
+     * @brief Sets the rate limit of the ranges started from now on, shared by all of them.
+     * @param bytesPerSecond Rate limit in bytes per second, 0 for no limit.
+     */
+    void setRateLimit(const qint64 bytesPerSecond)
+    { m_rateLimit = bytesPerSecond; }
+
+    /**
+     * @brief Removes the stored state of the ranges, when the item is finished or cancelled.
+     */
+    void removeState();
+
+    /**
+     * @brief Returns true if the temporal file has been preallocated or there is a stored state of
+     * the ranges, the file has holes and can't be resumed by a single transfer.
+     */
+    bool hasPartialFile() const;
+
+    /**
+     * @brief Returns the arguments of the last curl process started, for diagnostics.
+     */
+    QStringList lastArguments() const
+    { return m_lastArguments; }
+
+  signals:
+    /**
+     * @brief Emitted every second while downloading.
+     * @param downloaded Bytes of the file downloaded.
+     * @param total Size of the file.
+     * @param speed Current speed in bytes per second.
+     */
+    void progress(qint64 downloaded, qint64 total, qint64 speed);
+
+    /**
+     * @brief Emitted when the transfer finishes, is stopped or there are no usable sources.
+     * @param code 0 on success, curl exit code otherwise.
+     */
+    void finished(int code);
+
+    /**
+     * @brief Emitted when the sources can't be downloaded by ranges (unknown size, no range
+     * support). The item must be downloaded with a single transfer from its url.
+     */
+    void unsupported();
+
+    /**
+     * @brief Emitted with information about the transfer for the console.
+     * @param text Message text.
+     */
+    void message(const QString &text);
+
+    /**
+     * @brief Emitted when a probe or range process starts, to sample its resource usage.
+     */
+    void processStarted();
+
+  private slots:
+    /**
+     * @brief Handles the end of a HEAD request.
+     * @param code curl exit code.
+     * @param status Process exit status.
+     */
+    void onProbeFinished(int code, QProcess::ExitStatus status);
+
+    /**
+     * @brief Writes the data received by a range process in the temporal file.
+     */
+    void onRangeData();
+
+    /**
+     * @brief Handles the end of a range process.
+     * @param code curl exit code.
+     * @param status Process exit status.
+     */
+    void onRangeFinished(int code, QProcess::ExitStatus status);
+
+    /**
+     * @brief Updates the speeds of the sources, reports the progress and stores the state.
+     */
+    void onTick();
+
+  private:
+    /**
+     * @brief Source of the file.
+     */
+    struct Source
+    {
+      QUrl url;                  /** url of the source. */
+      bool valid = false;        /** true if the probe verified the source. */
+      qint64 size = 0;           /** size reported by the probe, 0 if unknown. */
+      QString validator;         /** validator reported by the probe. */
+      bool ranges = false;       /** true if the source accepts byte ranges. */
+      unsigned int errors = 0;   /** number of failed ranges. */
+      int connections = 0;       /** number of running ranges. */
+      qint64 bytes = 0;          /** bytes received from the source. */
+      qint64 lastBytes = 0;      /** bytes received in the previous tick. */
+      double speed = 0;          /** average speed in bytes per second. */
+      QProcess *probe = nullptr; /** HEAD request process or nullptr. */
+      int probeError = 0;        /** curl code of the probe that got no answer, 0 if answered. */
+    };
+
+    /**
+     * @brief Byte range of the file.
+     */
+    struct Range
+    {
+      qint64 start = 0;            /** first byte of the range. */
+      qint64 end = 0;              /** last byte of the range, inclusive. */
+      qint64 written = 0;          /** bytes of the range written in the file. */
+      int source = -1;             /** index of the source downloading the range, -1 if none. */
+      QProcess *process = nullptr; /** curl process or nullptr. */
+      bool inBody = false;         /** true once the response headers have been read. */
+      QByteArray buffer;           /** response headers received so far. */
+      ConnectionLimiter::Connection connection; /** connection counted by the limiter. */
+
+      /**
+       * @brief Returns the number of bytes not yet written.
+       */
+      qint64 remaining() const
+      { return end - start + 1 - written; }
+    };
+
+    /**
+     * @brief Starts the HEAD requests of all the sources.
+     */
+    void probeSources();
+
+    /**
+     * @brief Verifies the sources and creates the ranges once all the probes have finished.
+     */
+    void onProbesDone();
+
+    /**
+     * @brief Verifies the pieces of the temporal file in a separate thread and starts the
+     * transfer of the ones that don't match.
+     */
+    void verifyPieces();
+
+    /**
+     * @brief Prepares the ranges and starts downloading them.
+     * @param pieces Result of the verification of the pieces or empty if not verified.
+     */
+    void startTransfer(const std::vector<bool> &pieces);
+
+    /**
+     * @brief Creates the temporal file and the initial ranges, or restores the previous ones.
+     * Returns false on error.
+     * @param pieces Result of the verification of the pieces, if not empty only the pieces that
+     * don't match are downloaded.
+     */
+    bool prepareRanges(const std::vector<bool> &pieces);
+
+    /**
+     * @brief Assigns ranges to the idle sources while there are connections available.
+     */
+    void schedule();
+
+    /**
+     * @brief Splits the largest running range and returns the index of the new one or -1.
+     * @param source Index of the source that will download the new range.
+     */
+    int splitLargestRange(const int source);
+
+    /**
+     * @brief Starts the curl process of a range.
+     * @param range Index of the range.
+     * @param source Index of the source.
+     */
+    void startRange(const int range, const int source);
+
+    /**
+     * @brief Parses the response headers at the start of the data of a range. Returns false if
+     * the response isn't the requested range.
+     * @param range Range information.
+     */
+    bool parseRangeHeaders(Range &range);
+
+    /**
+     * @brief Returns the index of the range downloaded by the given process or -1.
+     * @param process curl process.
+     */
+    int findRange(const QObject *process) const;
+
+    /**
+     * @brief Finishes the transfer if all ranges are complete or there are no usable sources.
+     */
+    void checkCompletion();
+
+    /**
+     * @brief Ends the transfer and emits finished().
+     * @param code 0 on success, curl exit code otherwise.
+     */
+    void finish(const int code);
+
+    /**
+     * @brief Kills all the running processes.
+     */
+    void killProcesses();
+
+    /**
+     * @brief Stores the ranges in the state file.
+     */
+    void saveState() const;
+
+    /**
+     * @brief Returns the common curl arguments of the probe and range processes.
+     */
+    QStringList baseArguments() const;
+
+    /**
+     * @brief Returns the path of the file storing the state of the ranges.
+     */
+    QString stateFile() const;
+
+    /**
+     * @brief Returns the path of the temporal file of the item.
+     */
+    QString temporalFile() const;
+
+    /**
+     * @brief Stops counting the connection of the range in the limiter.
+     * @param range Range information.
+     */
+    void closeConnection(Range &range);
+
+    const Utils::Configuration &m_config; /** application configuration reference. */
+    Utils::ItemInformation *m_item;       /** item information. */
+    ConnectionLimiter *m_limiter;         /** connections limiter or nullptr. */
+    std::vector<Source> m_sources;        /** url and mirrors of the item. */
+    std::vector<Range> m_ranges;          /** ranges of the file. */
+    QFile m_file;                         /** temporal file. */
+    QTimer m_timer;                       /** progress timer. */
+    bool m_running;                       /** true if probing or downloading. */
+    qint64 m_totalSize;                   /** size of the file or 0 if unknown. */
+    qint64 m_lastDownloaded;              /** downloaded bytes in the previous tick. */
+    double m_speed;                       /** average speed in bytes per second. */
+    unsigned int m_maxConnections;        /** maximum number of simultaneous ranges. */
+    qint64 m_rateLimit;                   /** rate limit in bytes per second of all the ranges, 0 for no limit. */
+    int m_lastError;                      /** last curl error of a range. */
+    unsigned int m_ticks;                 /** ticks since the start, used to store the state periodically. */
+    unsigned int m_generation;            /** incremented on every stop to ignore the results of previous verifications. */
+    QStringList m_lastArguments;          /** arguments of the last process started. */
+    bool m_preallocated;                  /** true if the temporal file has been preallocated. */
+    unsigned int m_probeFailures;         /** consecutive attempts with sources that didn't answer the probe. */
+};
+
+#endif
@@ -0,0 +1,367 @@
+/*
+ File: Tracer.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Tracer.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QFile>
+
+// C++
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  const char *CATEGORY = "downloader";
+  constexpr std::size_t BUFFER_CAPACITY = 8192; // must be a power of two.
+  constexpr std::size_t DETAIL_LENGTH = 64;
+  constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(250);
+
+  /**
+   * @brief Trace event as stored in the thread buffers.
+   */
+  struct Event
+  {
+    const char   *name;                 /** event name. */
+    char          phase;                /** trace-event phase character. */
+    std::uint64_t timestamp;            /** timestamp in microseconds. */
+    std::uint64_t duration;             /** duration in microseconds, only for complete events. */
+    std::uint64_t id;                   /** item identifier or 0. */
+    const char   *argName;              /** numeric argument name or nullptr. */
+    std::int64_t  argValue;             /** numeric argument value. */
+    char          detail[DETAIL_LENGTH]; /** detail text, null terminated. */
+  };
+
+  /**
+   * @brief Single producer single consumer ring buffer owned by one thread.
+   */
+  struct ThreadBuffer
+  {
+    std::array<Event, BUFFER_CAPACITY> events;     /** event storage. */
+    std::atomic<std::size_t>           head{0};    /** next slot to write, modified by the producer. */
+    std::atomic<std::size_t>           tail{0};    /** next slot to read, modified by the consumer. */
+    std::atomic<std::uint64_t>         dropped{0}; /** events dropped because the buffer was full. */
+    std::uint64_t                      threadId{0};/** trace thread identifier. */
+  };
+
+  /**
+   * @brief Owns the thread buffers and the background flushing thread.
+   */
+  class Recorder
+  {
+    public:
+      static Recorder &instance()
+      {
+        static Recorder recorder;
+        return recorder;
+      }
+
+      ~Recorder()
+      { stop(); }
+
+      bool start(const QString &filename)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_thread.joinable()) return true;
+
+        m_file.setFileName(filename);
+        if(!m_file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+          return false;
+
+        m_file.write("[\n");
+        m_first = true;
+        m_stop = false;
+        m_pid = QCoreApplication::applicationPid();
+        m_origin = std::chrono::steady_clock::now();
+        m_thread = std::thread(&Recorder::run, this);
+        enabled.store(true, std::memory_order_release);
+
+        return true;
+      }
+
+      void stop()
+      {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          if(!m_thread.joinable()) return;
+          enabled.store(false, std::memory_order_release);
+          m_stop = true;
+        }
+        m_condition.notify_all();
+        m_thread.join();
+
+        flush();
+        m_file.write("\n]\n");
+        m_file.close();
+      }
+
+      std::uint64_t now() const
+      {
+        const auto elapsed = std::chrono::steady_clock::now() - m_origin;
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+      }
+
+      void push(const Event &event)
+      {
+        auto buffer = localBuffer();
+        const auto head = buffer->head.load(std::memory_order_relaxed);
+        const auto tail = buffer->tail.load(std::memory_order_acquire);
+        if(head - tail >= BUFFER_CAPACITY)
+        {
+          buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+
+        buffer->events[head & (BUFFER_CAPACITY - 1)] = event;
+        buffer->head.store(head + 1, std::memory_order_release);
+      }
+
+      std::atomic<bool> enabled{false}; /** true if recording and false otherwise. */
+
+    private:
+      Recorder() = default;
+
+      ThreadBuffer *localBuffer()
+      {
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if(!buffer)
+        {
+          buffer = std::make_shared<ThreadBuffer>();
+          buffer->threadId = std::hash<std::thread::id>{}(std::this_thread::get_id()) & 0xFFFFFFFF;
+
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_buffers.push_back(buffer);
+        }
+
+        return buffer.get();
+      }
+
+      void run()
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(!m_stop)
+        {
+          m_condition.wait_for(lock, FLUSH_INTERVAL);
+          lock.unlock();
+          flush();
+          lock.lock();
+        }
+      }
+
+      void flush()
+      {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          buffers = m_buffers;
+        }
+
+        std::string text;
+        for(auto &buffer: buffers)
+        {
+          const auto tail = buffer->tail.load(std::memory_order_relaxed);
+          const auto head = buffer->head.load(std::memory_order_acquire);
+          for(auto i = tail; i != head; ++i)
+            serialize(buffer->events[i & (BUFFER_CAPACITY - 1)], buffer->threadId, text);
+          buffer->tail.store(head, std::memory_order_release);
+
+          const auto dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+          if(dropped > 0)
+          {
+            Event event{"events dropped", 'i', now(), 0, 0, "count", static_cast<std::int64_t>(dropped), {0}};
+            serialize(event, buffer->threadId, text);
+          }
+        }
+
+        if(!text.empty())
+        {
+          m_file.write(text.data(), text.size());
+          m_file.flush();
+        }
+      }
+
+      void serialize(const Event &event, const std::uint64_t threadId, std::string &text)
+      {
+        text += m_first ? "" : ",\n";
+        m_first = false;
+
+        text += "{\"name\":\"";
+        text += event.name;
+        text += "\",\"cat\":\"";
+        text += CATEGORY;
+        text += "\",\"ph\":\"";
+        text += event.phase;
+        text += "\",\"ts\":" + std::to_string(event.timestamp);
+        text += ",\"pid\":" + std::to_string(m_pid);
+        text += ",\"tid\":" + std::to_string(threadId);
+
+        switch(event.phase)
+        {
+          case 'X':
+            text += ",\"dur\":" + std::to_string(event.duration);
+            break;
+          case 'i':
+            text += ",\"s\":\"t\"";
+            break;
+          case 'b':
+          case 'e':
+            text += ",\"id\":\"0x" + QByteArray::number(static_cast<qulonglong>(event.id), 16).toStdString() + "\"";
+            break;
+          default:
+            break;
+        }
+
+        text += ",\"args\":{";
+        bool hasArgs = false;
+        auto addSeparator = [&text, &hasArgs]() { if(hasArgs) text += ","; hasArgs = true; };
+
+        if(event.id != 0 && event.phase != 'b' && event.phase != 'e')
+        {
+          addSeparator();
+          text += "\"item\":\"0x" + QByteArray::number(static_cast<qulonglong>(event.id), 16).toStdString() + "\"";
+        }
+
+        if(event.argName)
+        {
+          addSeparator();
+          text += "\"";
+          text += event.argName;
+          text += "\":" + std::to_string(event.argValue);
+        }
+
+        if(event.detail[0] != 0)
+        {
+          addSeparator();
+          text += "\"detail\":\"";
+          for(const char *c = event.detail; *c != 0; ++c)
+          {
+            if(*c == '"' || *c == '\\')
+            {
+              text += '\\';
+              text += *c;
+            }
+            else if(static_cast<unsigned char>(*c) < 0x20)
+              text += ' ';
+            else
+              text += *c;
+          }
+          text += "\"";
+        }
+
+        text += "}}";
+      }
+
+      std::mutex                                 m_mutex;     /** protects registration and lifecycle. */
+      std::condition_variable                    m_condition; /** wakes the flushing thread. */
+      std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;   /** registered thread buffers. */
+      std::thread                                m_thread;    /** flushing thread. */
+      bool                                       m_stop{false};  /** true to stop the flushing thread. */
+      bool                                       m_first{true};  /** true if no event has been written yet. */
+      qint64                                     m_pid{0};       /** application process id. */
+      QFile                                      m_file;      /** trace output file. */
+      std::chrono::steady_clock::time_point      m_origin;    /** timestamps origin. */
+  };
+
+  /**
+   * @brief Helper to build and push an event.
+   */
+  void record(const char phase, const char *name, const std::uint64_t id, const char *argName,
+              const std::int64_t argValue, const std::uint64_t timestamp, const std::uint64_t duration,
+              const QString &detail = QString())
+  {
+    auto &recorder = Recorder::instance();
+
+    Event event{name, phase, timestamp, duration, id, argName, argValue, {0}};
+    if(!detail.isEmpty())
+    {
+      const auto utf8 = detail.toUtf8();
+      std::strncpy(event.detail, utf8.constData(), DETAIL_LENGTH - 1);
+      event.detail[DETAIL_LENGTH - 1] = 0;
+    }
+
+    recorder.push(event);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool Tracer::start(const QString &filename)
+{
+  return Recorder::instance().start(filename);
+}
+
+//----------------------------------------------------------------------------
+void Tracer::stop()
+{
+  Recorder::instance().stop();
+}
+
+//----------------------------------------------------------------------------
+bool Tracer::isEnabled()
+{
+  return Recorder::instance().enabled.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------
+void Tracer::instant(const char *name, const std::uint64_t id, const char *argName, const std::int64_t argValue, const QString &detail)
+{
+  if(!isEnabled()) return;
+  record('i', name, id, argName, argValue, Recorder::instance().now(), 0, detail);
+}
+
+//----------------------------------------------------------------------------
+void Tracer::asyncBegin(const char *name, const std::uint64_t id)
+{
+  if(!isEnabled()) return;
+  record('b', name, id, nullptr, 0, Recorder::instance().now(), 0);
+}
+
+//----------------------------------------------------------------------------
+void Tracer::asyncEnd(const char *name, const std::uint64_t id, const char *argName, const std::int64_t argValue)
+{
+  if(!isEnabled()) return;
+  record('e', name, id, argName, argValue, Recorder::instance().now(), 0);
+}
+
+//----------------------------------------------------------------------------
+Tracer::ScopedSpan::ScopedSpan(const char *name, const std::uint64_t id)
+: m_name{name}
+, m_id{id}
+, m_start{isEnabled() ? Recorder::instance().now() + 1 : 0}
+{
+}
+
+//----------------------------------------------------------------------------
+Tracer::ScopedSpan::~ScopedSpan()
+{
+  if(m_start == 0 || !isEnabled()) return;
+
+  const auto start = m_start - 1;
+  record('X', m_name, m_id, nullptr, 0, start, Recorder::instance().now() - start);
+}
@@ -0,0 +1,104 @@
+/*
+ File: Tracer.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACER_H_
+#define _TRACER_H_
+
+// Qt
+#include <QString>
+
+// C++
+#include <cstdint>
+
+/**
+ * @brief Chrome/Perfetto trace-event recorder. Events are stored in a lock-free per-thread
+ * ring buffer and written to the trace file by a background thread. When the tracer is not
+ * started every call returns after checking an atomic flag.
+ * Names and argument names must be string literals, only the detail text is copied.
+ */
+namespace Tracer
+{
+  /**
+   * @brief Starts recording events to the given file. Returns true on success.
+   * @param filename Trace JSON file path.
+   */
+  bool start(const QString &filename);
+
+  /**
+   * @brief Flushes the pending events, closes the trace file and stops recording.
+   */
+  void stop();
+
+  /**
+   * @brief Returns true if the tracer is recording and false otherwise.
+   */
+  bool isEnabled();
+
+  /**
+   * @brief Records an instant event.
+   * @param name Event name.
+   * @param id Identifier of the item the event refers to or 0.
+   * @param argName Name of the numeric argument or nullptr.
+   * @param argValue Value of the numeric argument.
+   * @param detail Optional detail text.
+   */
+  void instant(const char *name, const std::uint64_t id = 0, const char *argName = nullptr, const std::int64_t argValue = 0, const QString &detail = QString());
+
+  /**
+   * @brief Begins an asynchronous span, spans with the same name and id are paired.
+   * @param name Span name.
+   * @param id Identifier of the item the span refers to.
+   */
+  void asyncBegin(const char *name, const std::uint64_t id);
+
+  /**
+   * @brief Ends an asynchronous span.
+   * @param name Span name.
+   * @param id Identifier of the item the span refers to.
+   * @param argName Name of the numeric argument or nullptr.
+   * @param argValue Value of the numeric argument.
+   */
+  void asyncEnd(const char *name, const std::uint64_t id, const char *argName = nullptr, const std::int64_t argValue = 0);
+
+  /**
+   * @brief Records a complete event covering the lifetime of the object.
+   */
+  class ScopedSpan
+  {
+    public:
+      /**
+       * @brief ScopedSpan class constructor.
+       * @param name Span name.
+       * @param id Identifier of the item the span refers to or 0.
+       */
+      explicit ScopedSpan(const char *name, const std::uint64_t id = 0);
+
+      /**
+       * @brief ScopedSpan class destructor. Records the event.
+       */
+      ~ScopedSpan();
+
+    private:
+      const char   *m_name;  /** span name. */
+      std::uint64_t m_id;    /** item identifier. */
+      std::uint64_t m_start; /** start timestamp in microseconds, 0 if disabled. */
+  };
+}
+
+#endif
@@ -0,0 +1,268 @@
+/*
+ File: UrlGlob.cpp
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <UrlGlob.h>
+
+// Qt
+#include <QRegularExpression>
+#include <QFileInfo>
+
+// C++
+#include <limits>
+#include <memory>
+
+const QRegularExpression NUMERIC_RANGE("^([0-9]+)-([0-9]+)(?::([0-9]+))?$");
+const QRegularExpression LETTER_RANGE("^([a-zA-Z])-([a-zA-Z])(?::([0-9]+))?$");
+const QRegularExpression NAME_REFERENCE("#([0-9]+)");
+
+//----------------------------------------------------------------------------
+QString UrlGlob::Segment::value(const qint64 index) const
+{
+  if(!values.isEmpty()) return values.at(index);
+
+  const auto number = first + index * step;
+  if(letters) return QString(QChar(static_cast<char16_t>(number)));
+
+  return QString("%1").arg(number, padding, 10, QChar('0'));
+}
+
+//----------------------------------------------------------------------------
+UrlGlob::UrlGlob(const QString &pattern, const Utils::ItemInformation &item)
+: m_pattern{pattern.trimmed()}
+, m_item{item}
+, m_count{0}
+, m_generated{0}
+, m_skipped{0}
+, m_globsInName{true}
+{
+  m_item.mirrors.clear();
+  parse();
+}
+
+//----------------------------------------------------------------------------
+Utils::ItemInformation *UrlGlob::next()
+{
+  if(!hasNext()) return nullptr;
+
+  QString url;
+  QStringList values;
+  for(size_t i = 0; i < m_segments.size(); ++i)
+  {
+    const auto &segment = m_segments.at(i);
+    if(segment.size == 0)
+    {
+      url += segment.text;
+      continue;
+    }
+
+    const auto value = segment.value(m_indexes.at(i));
+    url += value;
+    values << value;
+  }
+
+  // the last glob changes first.
+  for(auto i = static_cast<int>(m_segments.size()) - 1; i >= 0; --i)
+  {
+    if(m_segments.at(i).size == 0) continue;
+    if(++m_indexes[i] < m_segments.at(i).size) break;
+    m_indexes[i] = 0;
+  }
+  ++m_generated;
+
+  auto item = new Utils::ItemInformation(m_item);
+  item->url = QUrl(url);
+
+  if(!m_item.outputName.isEmpty())
+  {
+    // replace '#n' references, unknown ones are left as they are.
+    QString name;
+    qsizetype last = 0;
+    auto it = NAME_REFERENCE.globalMatch(m_item.outputName);
+    while(it.hasNext())
+    {
+      const auto match = it.next();
+      const auto reference = match.captured(1).toInt();
+      name += m_item.outputName.mid(last, match.capturedStart() - last);
+      name += (reference >= 1 && reference <= values.size()) ? values.at(reference - 1) : match.captured();
+      last = match.capturedEnd();
+    }
+    name += m_item.outputName.mid(last);
+    item->outputName = QFileInfo(name).fileName();
+  }
+  else
+  {
+    // globs in the host or folders would produce the same file name for different urls.
+    item->outputName = item->url.fileName();
+    if(item->outputName.isEmpty())
+      item->outputName = values.join('_');
+    else if(!m_globsInName)
+      item->outputName = values.join('_') + '_' + item->outputName;
+  }
+
+  return item;
+}
+
+//----------------------------------------------------------------------------
+bool UrlGlob::hasNameReference(const QString &name)
+{
+  return NAME_REFERENCE.match(name).hasMatch();
+}
+
+//----------------------------------------------------------------------------
+void UrlGlob::parse()
+{
+  Segment text;
+  qsizetype lastSlash = -1; // segment with the last '/' of the path.
+  qsizetype query = -1;     // segment with the start of the query.
+
+  auto addText = [this, &text]()
+  {
+    if(!text.text.isEmpty())
+    {
+      m_segments.push_back(text);
+      text = Segment();
+    }
+  };
+
+  for(qsizetype i = 0; i < m_pattern.size(); ++i)
+  {
+    const auto c = m_pattern.at(i);
+
+    if(c == '\\' && i + 1 < m_pattern.size())
+    {
+      text.text += m_pattern.at(++i);
+      continue;
+    }
+
+    if(c != '{' && c != '[')
+    {
+      if(c == '/' && query == -1) lastSlash = static_cast<qsizetype>(m_segments.size());
+      if(c == '?' && query == -1) query = static_cast<qsizetype>(m_segments.size());
+      text.text += c;
+      continue;
+    }
+
+    const auto closing = m_pattern.indexOf(c == '{' ? '}' : ']', i + 1);
+    if(closing == -1)
+    {
+      m_error = QString("Unmatched '%1' at position %2.").arg(c).arg(i + 1);
+      return;
+    }
+
+    addText();
+
+    Segment glob;
+    const auto contents = m_pattern.mid(i + 1, closing - i - 1);
+    if(c == '{')
+    {
+      glob.values = contents.split(',');
+      glob.size = glob.values.size();
+    }
+    else if(!parseRange(contents, glob))
+    {
+      m_error = QString("Invalid range '[%1]' at position %2.").arg(contents).arg(i + 1);
+      return;
+    }
+
+    m_segments.push_back(glob);
+    i = closing;
+  }
+  addText();
+
+  m_count = 0;
+  for(size_t i = 0; i < m_segments.size(); ++i)
+  {
+    const auto size = static_cast<quint64>(m_segments.at(i).size);
+    if(size == 0) continue;
+
+    const auto index = static_cast<qsizetype>(i);
+    if(index < lastSlash || (query != -1 && index > query)) m_globsInName = false;
+
+    if(m_count == 0)
+      m_count = size;
+    else if(m_count > std::numeric_limits<quint64>::max() / size)
+    {
+      m_error = "The pattern has too many urls.";
+      return;
+    }
+    else
+      m_count *= size;
+  }
+
+  if(m_count == 0)
+  {
+    m_error = "The pattern has no '{}' or '[]' globs.";
+    return;
+  }
+
+  m_indexes.assign(m_segments.size(), 0);
+
+  // the first url must be valid, the rest only change the glob values.
+  const std::unique_ptr<Utils::ItemInformation> firstItem{next()};
+  const auto first = firstItem->url;
+  m_generated = 0;
+  m_indexes.assign(m_segments.size(), 0);
+
+  if(!first.isValid() || first.isRelative())
+    m_error = QString("The url '%1' is not valid.").arg(first.toString());
+}
+
+//----------------------------------------------------------------------------
+bool UrlGlob::parseRange(const QString &text, Segment &segment)
+{
+  auto match = NUMERIC_RANGE.match(text);
+  segment.letters = !match.hasMatch();
+  if(segment.letters)
+  {
+    match = LETTER_RANGE.match(text);
+    if(!match.hasMatch()) return false;
+  }
+
+  const auto firstText = match.captured(1);
+  const auto lastText = match.captured(2);
+
+  qint64 first, last;
+  if(segment.letters)
+  {
+    // both ends must be of the same case.
+    if(firstText.at(0).isUpper() != lastText.at(0).isUpper()) return false;
+    first = firstText.at(0).unicode();
+    last = lastText.at(0).unicode();
+  }
+  else
+  {
+    bool ok1, ok2;
+    first = firstText.toLongLong(&ok1);
+    last = lastText.toLongLong(&ok2);
+    if(!ok1 || !ok2) return false;
+
+    // '[001-100]' values are zero padded.
+    if(firstText.size() > 1 && firstText.startsWith('0'))
+      segment.padding = firstText.size();
+  }
+
+  segment.step = match.captured(3).isEmpty() ? 1 : match.captured(3).toLongLong();
+  if(first > last || segment.step < 1) return false;
+
+  segment.first = first;
+  segment.size = (last - first) / segment.step + 1;
+
+  return true;
+}
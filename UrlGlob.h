@@ -0,0 +1,159 @@
+/*
+ File: UrlGlob.h
+ Created on: 19/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _URL_GLOB_H_
+#define _URL_GLOB_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QString>
+#include <QStringList>
+
+// C++
+#include <vector>
+
+/**
+ * @brief Generator of the items of an url pattern with the curl glob syntax: sets '{a,b,c}',
+ * numeric ranges '[1-100]', '[001-500]' (zero padded), '[0-100:5]' (with step) and letter ranges
+ * '[a-z]'. '\' escapes the next character. The urls are generated one at a time, in order, so
+ * the memory used doesn't depend on the number of urls. The output name can reference the value
+ * of the n-th pattern with '#n'.
+ */
+class UrlGlob
+{
+  public:
+    /**
+     * @brief UrlGlob class constructor. Check isValid() before use.
+     * @param pattern Url pattern.
+     * @param item Information used for all the generated items (proxy, output name template).
+     */
+    UrlGlob(const QString &pattern, const Utils::ItemInformation &item);
+
+    /**
+     * @brief Returns true if the pattern is valid and has at least one glob.
+     */
+    bool isValid() const
+    { return m_error.isEmpty(); }
+
+    /**
+     * @brief Returns the error description of an invalid pattern.
+     */
+    QString error() const
+    { return m_error; }
+
+    /**
+     * @brief Returns the pattern.
+     */
+    QString pattern() const
+    { return m_pattern; }
+
+    /**
+     * @brief Returns the priority of the generated items.
+     */
+    Utils::Priority priority() const
+    { return m_item.priority; }
+
+    /**
+     * @brief Returns the total number of urls of the pattern.
+     */
+    quint64 count() const
+    { return m_count; }
+
+    /**
+     * @brief Returns the number of urls not generated yet.
+     */
+    quint64 remaining() const
+    { return m_count - m_generated; }
+
+    /**
+     * @brief Returns true if there are urls not generated yet.
+     */
+    bool hasNext() const
+    { return isValid() && m_generated < m_count; }
+
+    /**
+     * @brief Returns the next item or nullptr if there are no more. The caller takes ownership.
+     */
+    Utils::ItemInformation *next();
+
+    /**
+     * @brief Returns true if the output name references the value of a pattern with '#n'.
+     * @param name Output name template.
+     */
+    static bool hasNameReference(const QString &name);
+
+    /**
+     * @brief Counts a generated url that wasn't queued because it was already queued.
+     */
+    void skip()
+    { ++m_skipped; }
+
+    /**
+     * @brief Returns the number of generated urls that weren't queued.
+     */
+    quint64 skipped() const
+    { return m_skipped; }
+
+  private:
+    /**
+     * @brief Part of the pattern, a fixed text or a set of values.
+     */
+    struct Segment
+    {
+      QString     text;          /** fixed text, if not a glob. */
+      QStringList values;        /** set values, for '{}' globs. */
+      qint64      first = 0;     /** first value of a range. */
+      qint64      step = 1;      /** step of a range. */
+      qint64      size = 0;      /** number of values of the glob, 0 for fixed text. */
+      int         padding = 0;   /** width of numeric range values. */
+      bool        letters = false; /** true for letter ranges. */
+
+      /**
+       * @brief Returns the value at the given index of the glob.
+       * @param index Value index in [0, size).
+       */
+      QString value(const qint64 index) const;
+    };
+
+    /**
+     * @brief Parses the pattern into segments, sets the error on failure.
+     */
+    void parse();
+
+    /**
+     * @brief Parses the range glob '[...]' contents. Returns false if invalid.
+     * @param text Range text without the brackets.
+     * @param segment Segment to fill.
+     */
+    bool parseRange(const QString &text, Segment &segment);
+
+    QString                m_pattern;   /** url pattern. */
+    Utils::ItemInformation m_item;      /** item template. */
+    QString                m_error;     /** error of the pattern or empty if valid. */
+    std::vector<Segment>   m_segments;  /** pattern parts. */
+    std::vector<qint64>    m_indexes;   /** value index of each segment of the next url. */
+    quint64                m_count;     /** total number of urls. */
+    quint64                m_generated; /** number of urls generated. */
+    quint64                m_skipped;   /** number of generated urls already queued. */
+    bool                   m_globsInName; /** true if all the globs are in the file name part of the url. */
+};
+
+#endif
@@ -27,6 +27,12 @@
 #include <QProcess>
 #include <QSettings>
 #include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QCryptographicHash>
+
+// C++
+#include <cstring>
 
 const QString INI_FILENAME = "CurlDownloader.ini";
 											 
@@ -35,7 +41,9 @@ bool Utils::ItemInformation::isValid() const
 {
   QHostAddress address(server);
   // url.isValid() is a joke... everything goes. Server and port can be empty.
-  return !url.isEmpty() && url.isValid() && (server.isEmpty() || (QAbstractSocket::UnknownNetworkLayerProtocol != address.protocol()));
+  auto isValidMirror = [](const QUrl &mirror) { return !mirror.isEmpty() && mirror.isValid() && !mirror.isRelative(); };
+  return !url.isEmpty() && url.isValid() && (server.isEmpty() || (QAbstractSocket::UnknownNetworkLayerProtocol != address.protocol())) &&
+         std::all_of(mirrors.cbegin(), mirrors.cend(), isValidMirror);
 }
 
 //----------------------------------------------------------------------------
@@ -43,7 +51,9 @@ QString Utils::ItemInformation::toText() const
 {
   QString text;
   text += QString("File: %1\n").arg(url.toString());
-  if(!server.isEmpty())
+  if(usePool)
+    text += QString("Proxy pool: %1\n").arg(server.isEmpty() ? "No proxy assigned" : QString("%1:%2").arg(server).arg(port));
+  else if(!server.isEmpty())
   {
     text += QString("Proxy server: %1:%2\n").arg(server).arg(port);
     text += QString("Protocol: %1\n").arg(protocol == Protocol::SOCKS4 ? "SOCKS4": (protocol == Protocol::NONE) ? "None":"SOCKS5");
@@ -51,6 +61,18 @@ QString Utils::ItemInformation::toText() const
   else
     text += QString("Proxy server: None\n");
 
+  if(!mirrors.isEmpty())
+    text += QString("Mirrors: %1\n").arg(mirrors.size());
+
+  if(background)
+    text += QString("Background transfer: Yes\n");
+
+  if(extract)
+    text += QString("Extract while downloading: Yes\n");
+
+  if(!postProcessing.isEmpty())
+    text += QString("Post-processing: %1\n").arg(postProcessing.join(", "));
+
   text += "Output name: " + outputName;
   
   return text;
@@ -59,7 +81,36 @@ QString Utils::ItemInformation::toText() const
 //----------------------------------------------------------------------------
 bool Utils::ItemInformation::operator==(const ItemInformation &other)
 {
-  return (url == other.url) && (server == other.server) && (port == other.port) && (protocol == other.protocol) && (outputName == other.outputName);
+  return (url == other.url) && (server == other.server) && (port == other.port) && (protocol == other.protocol) && (outputName == other.outputName) && (usePool == other.usePool) && (mirrors == other.mirrors);
+}
+
+//----------------------------------------------------------------------------
+QString Utils::priorityName(const Priority priority)
+{
+  switch(priority)
+  {
+    case Priority::LOW:  return "low";
+    case Priority::HIGH: return "high";
+    default:
+      break;
+  }
+
+  return "normal";
+}
+
+//----------------------------------------------------------------------------
+bool Utils::priorityFromName(const QString &name, Priority &priority)
+{
+  for(const auto value: {Priority::LOW, Priority::NORMAL, Priority::HIGH})
+  {
+    if(name.compare(priorityName(value), Qt::CaseInsensitive) == 0)
+    {
+      priority = value;
+      return true;
+    }
+  }
+
+  return false;
 }
 
 //----------------------------------------------------------------------------
@@ -73,6 +124,52 @@ std::vector<Utils::ItemInformation *>::const_iterator Utils::findItem(const QUrl
   return it;
 }
 
+//----------------------------------------------------------------------------
+quint64 Utils::urlKey(const QUrl &url)
+{
+  const auto text = url.adjusted(QUrl::NormalizePathSegments|QUrl::StripTrailingSlash).toString(QUrl::FullyEncoded).toUtf8();
+  const auto hash = QCryptographicHash::hash(text, QCryptographicHash::Md5);
+
+  quint64 key = 0;
+  std::memcpy(&key, hash.constData(), sizeof(key));
+  return key;
+}
+
+//----------------------------------------------------------------------------
+void Utils::connectionTarget(const ItemInformation &item, QString &host, quint16 &port)
+{
+  if(!item.server.isEmpty())
+  {
+    host = item.server;
+    port = static_cast<quint16>(item.port);
+    return;
+  }
+
+  const auto scheme = item.url.scheme().toLower();
+  const int defaultPort = scheme == "https" ? 443 : (scheme == "ftp" ? 21 : (scheme == "ftps" ? 990 : 80));
+  host = item.url.host();
+  port = static_cast<quint16>(item.url.port(defaultPort));
+}
+
+//----------------------------------------------------------------------------
+qint64 Utils::curlSizeToBytes(const QString &text)
+{
+  const QString units = "kMGTP";
+
+  auto value = text.trimmed();
+  if(value.isEmpty()) return 0;
+
+  qint64 multiplier = 1;
+  const auto unitIndex = units.indexOf(value.back());
+  if(unitIndex != -1)
+  {
+    multiplier = static_cast<qint64>(1) << (10 * (unitIndex + 1));
+    value.chop(1);
+  }
+
+  return static_cast<qint64>(value.toDouble() * multiplier);
+}
+
 //----------------------------------------------------------------------------
 QString Utils::curlExecutableVersion(const QString &exePath)
 {
@@ -116,6 +213,108 @@ bool Utils::Configuration::isValid() const
   return !curlPath.isEmpty() && !downloadPath.isEmpty() && directory.exists() && waitSeconds >= 5 && !curlExecutableVersion(curlPath).isEmpty();
 }
 
+//----------------------------------------------------------------------------
+QString Utils::Configuration::failureTracesFolder() const
+{
+  return QDir(downloadPath).absoluteFilePath("failure traces");
+}
+
+//----------------------------------------------------------------------------
+QString Utils::Configuration::metadataFolder() const
+{
+  return QDir(downloadPath).absoluteFilePath(".curlDownloader");
+}
+
+//----------------------------------------------------------------------------
+QString Utils::Configuration::historyFile() const
+{
+  return QDir(metadataFolder()).absoluteFilePath("history.txt");
+}
+
+//----------------------------------------------------------------------------
+int Utils::ResponseHeaders::retryAfter() const
+{
+  if(!headers.contains("retry-after"))
+    return -1;
+
+  const auto value = headers.value("retry-after");
+
+  bool isValid = false;
+  const auto seconds = value.toInt(&isValid);
+  if(isValid)
+    return std::max(0, seconds);
+
+  const auto date = QDateTime::fromString(value, Qt::RFC2822Date);
+  if(!date.isValid())
+    return -1;
+
+  return std::max(static_cast<qint64>(0), QDateTime::currentDateTimeUtc().secsTo(date));
+}
+
+//----------------------------------------------------------------------------
+QString Utils::ResponseHeaders::validator() const
+{
+  // weak ETags can't be used in If-Range.
+  const auto etag = headers.value("etag");
+  if(!etag.isEmpty() && !etag.startsWith("W/"))
+    return etag;
+
+  return headers.value("last-modified");
+}
+
+//----------------------------------------------------------------------------
+Utils::ResponseHeaders Utils::parseResponseHeaders(const QByteArray &data)
+{
+  ResponseHeaders result;
+
+  // curl writes the headers of every response (redirects, proxy connect), keep the last one.
+  for(const auto &rawLine: data.split('\n'))
+  {
+    const auto line = QString::fromLatin1(rawLine).trimmed();
+    if(line.isEmpty()) continue;
+
+    if(line.startsWith("HTTP/", Qt::CaseInsensitive))
+    {
+      result.headers.clear();
+      result.status = line.section(' ', 1, 1).toInt();
+      continue;
+    }
+
+    const auto separator = line.indexOf(':');
+    if(separator > 0)
+      result.headers.insert(line.left(separator).trimmed().toLower(), line.mid(separator + 1).trimmed());
+  }
+
+  return result;
+}
+
+//----------------------------------------------------------------------------
+Utils::ResponseHeaders Utils::readResponseHeaders(const QString &filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    return ResponseHeaders();
+
+  return parseResponseHeaders(file.readAll());
+}
+
+//----------------------------------------------------------------------------
+QStringList Utils::curlProxyArguments(const ItemInformation &item)
+{
+  const QStringList protocols = {"--socks4", "--socks5"};
+
+  QStringList arguments;
+  if(!item.server.isEmpty() && (item.protocol != Utils::Protocol::NONE))
+  {
+    arguments << "--proxy-insecure"; // Do HTTPS proxy connections without verifying the proxy
+
+    const auto serverText = QString("%1:%2").arg(item.server).arg(item.port);
+    arguments << protocols.at(static_cast<int>(item.protocol)) << serverText;
+  }
+
+  return arguments;
+}
+
 //----------------------------------------------------------------------------
 void Utils::AutoCloseMessageBox::showEvent(QShowEvent *event)
 {   
@@ -20,12 +20,17 @@
 #ifndef _UTILS_H_
 #define _UTILS_H_
 
+// Project
+#include <RetryPolicy.h>
+
 // c++
 #include <vector>
 
 // Qt
+#include <QMap>
 #include <QUrl>
 #include <QString>
+#include <QStringList>
 #include <QMessageBox>
 #include <QLabel>
 #include <QPainter>
@@ -46,6 +51,47 @@ namespace Utils
     NONE = 2
   };
 
+  /**
+   * @brief Download priority enum, higher values start first.
+   */
+  enum class Priority : char
+  {
+    LOW = 0,
+    NORMAL = 1,
+    HIGH = 2
+  };
+
+  /**
+   * @brief Returns the name of the priority.
+   * @param priority Priority value.
+   */
+  QString priorityName(const Priority priority);
+
+  /**
+   * @brief Returns the priority with the given name. Returns false if the name is not valid.
+   * @param name Priority name, case insensitive.
+   * @param priority Priority value.
+   */
+  bool priorityFromName(const QString &name, Priority &priority);
+
+  /**
+   * @brief Hashes of a file from a manifest, used to verify the download.
+   */
+  struct FileHashes
+  {
+    QString type;             /** algorithm of the whole file hash (sha-256, sha-1, md5...), empty if none. */
+    QByteArray hash;          /** whole file hash. */
+    QString pieceType;        /** algorithm of the pieces hashes. */
+    qint64 pieceLength = 0;   /** size of the pieces in bytes. */
+    QList<QByteArray> pieces; /** hashes of the consecutive pieces of the file. */
+
+    /**
+     * @brief Returns true if there is nothing to verify.
+     */
+    bool isEmpty() const
+    { return hash.isEmpty() && pieces.isEmpty(); }
+  };
+
   /**
    * @brief Item information struct.
    */
@@ -56,6 +102,16 @@ namespace Utils
     unsigned int port;  /** server address port. */
     Protocol protocol;  /** protocol version used. */
     QString outputName; /** output file name. */
+    QString validator;  /** ETag or Last-Modified value of the first response, used to validate resumes. */
+    bool usePool = false; /** true to use the proxies of the proxy pool. */
+    QList<QUrl> mirrors;  /** other urls of the same file, downloaded by ranges at the same time as the url. */
+    qint64 size = 0;      /** expected size of the file, 0 if unknown. */
+    FileHashes hashes;    /** hashes to verify the file. */
+    quint64 id = 0;       /** unique identifier assigned when queued, 0 if not queued. */
+    Priority priority = Priority::NORMAL; /** download priority. */
+    bool background = false; /** true to download with a rate that backs off when the link is busy. */
+    bool extract = false;    /** true to extract the archive while it's downloaded. */
+    QStringList postProcessing; /** stages run once downloaded, empty to use the ones of the patterns. */
 
     /**
      * @brief ItemInformation constructor.
@@ -106,6 +162,21 @@ namespace Utils
    */
   std::vector<ItemInformation*>::const_iterator findItem(const QUrl &url, const std::vector<ItemInformation *> &items);
 
+  /**
+   * @brief Returns a stable 64 bit key of the url, used to index the queued and downloaded urls.
+   * @param url Url.
+   */
+  quint64 urlKey(const QUrl &url);
+
+  /**
+   * @brief Returns the host and port of the first hop of the connections of the item, the proxy
+   * if it has one or the host of the url otherwise.
+   * @param item Item information.
+   * @param host Host name or address.
+   * @param port TCP port.
+   */
+  void connectionTarget(const ItemInformation &item, QString &host, quint16 &port);
+
   /**
    * @brief Configuration information struct.
    */
@@ -115,6 +186,59 @@ namespace Utils
     QString downloadPath;     /** path to download folder. */
     unsigned int waitSeconds; /** seconds to wait between retries. */
     QString extension;        /** extensio to use when downloading. */
+    QString traceFile;        /** Chrome trace events file, empty to disable tracing. */
+    unsigned int failureTraceSize = 512;        /** size of the curl trace kept per attempt in KB, 0 to disable. */
+    unsigned int failureTracesPerItem = 5;      /** maximum number of failure traces stored per item. */
+    unsigned int failureTracesFolderSize = 64;  /** maximum size of the failure traces folder in MB. */
+    RetryPolicy retryPolicy;                    /** classification of the errors for retrying. */
+    unsigned int stallSpeed = 1024;             /** minimum speed in bytes per second, 0 to disable stall detection. */
+    unsigned int stallWindow = 60;              /** seconds used to measure the speed for stall detection. */
+    unsigned int stallGracePeriod = 30;         /** seconds after the start of an attempt without stall detection. */
+    unsigned int nonResumableStallFactor = 4;   /** stall window and grace period multiplier for servers that can't resume. */
+    unsigned int nonResumableKeepAlive = 15;    /** TCP keepalive interval in seconds for servers that can't resume. */
+    unsigned int maxFullRestarts = 10;          /** maximum restarts from the beginning for servers that can't resume, 0 for no limit. */
+    QStringList proxyPool;                      /** proxies of the pool in 'protocol://server:port' format. */
+    unsigned int proxyProbeInterval = 60;       /** seconds between proxy pool probes. */
+    unsigned int maxSegments = 8;               /** maximum simultaneous ranges of an item with mirrors. */
+    unsigned int minSegmentSize = 1024;         /** minimum size of a range in KB. */
+    unsigned int maxSourceErrors = 3;           /** failed ranges before dropping a mirror. */
+    unsigned int maxActiveDownloads = 10;       /** items downloading at the same time, the rest wait in the queue, 0 for no limit. */
+    bool preemptLowPriority = false;            /** true to pause lower priority items when higher priority items are waiting. */
+    unsigned int maxConnectionsPerHost = 0;     /** connections to the same host at the same time, ranges included, 0 for no limit. */
+    unsigned int maxConnectionsPerProxy = 0;    /** connections through the same proxy at the same time, ranges included, 0 for no limit. */
+    bool adaptiveConcurrency = false;           /** true to tune the active downloads and segments per item by the measured throughput. */
+    QStringList schedule;                       /** schedule rules of the rate limit and active downloads, see Schedule. */
+    qint64 transferRateLimit = 0;               /** rate limit of each transfer in bytes per second set by the schedule, 0 for none. Not stored. */
+    QStringList connectivityProbes;             /** 'host:port' probed to detect network outages with the hosts of the failed items. */
+    unsigned int processNice = 0;               /** nice value of the curl processes in [0,19], 0 for the default. */
+    QString processIoClass;                     /** I/O class of the curl processes, 'idle' or 'best-effort', empty for the default. */
+    QString processCgroup;                      /** cgroup v2 directory of the curl processes, empty for none. */
+    unsigned int processCpuWeight = 0;          /** cpu.weight of the cgroup in [1,10000], 0 for the default. */
+    unsigned int processIoWeight = 0;           /** io.weight of the cgroup in [1,10000], 0 for the default. */
+    unsigned int processCpuMax = 0;             /** percentage of a CPU the cgroup can use, 0 for no limit. */
+    unsigned int processMemoryMax = 0;          /** memory of the cgroup in MB, 0 for no limit. */
+    bool streamOutput = false;                  /** true to stream the body to stdout and write it from the application. */
+    unsigned int outputBlockSize = 1024;        /** size of the writes of the streamed body in KB. */
+    unsigned int outputSyncInterval = 0;        /** MB written between syncs of the streamed body, 0 to sync only at the end. */
+    QString extractorPath = "tar";              /** path to the tar executable used to extract the archives. */
+    QMap<QString, QStringList> postProcessing;  /** post-processing stages of the downloaded files by name pattern. */
+    unsigned int postProcessingThreads = 2;     /** threads running post-processing stages. */
+    unsigned int postProcessingTimeout = 3600;  /** seconds a process of the extract and run stages can run, 0 for no limit. */
+
+    /**
+     * @brief Returns the folder where the traces of the failed attempts are stored.
+     */
+    QString failureTracesFolder() const;
+
+    /**
+     * @brief Returns the folder where the items metadata (response headers, etc) is stored.
+     */
+    QString metadataFolder() const;
+
+    /**
+     * @brief Returns the file with the urls of the downloaded items.
+     */
+    QString historyFile() const;
 
     /**
      * @brief Configuration struct constructor.
@@ -136,6 +260,50 @@ namespace Utils
     bool isValid() const;
   };
 
+  /**
+   * @brief Headers of the last response of a curl transfer.
+   */
+  struct ResponseHeaders
+  {
+    int status = 0;                  /** HTTP status code or 0 if unknown. */
+    QMap<QString, QString> headers;  /** header values by lowercase name. */
+
+    /**
+     * @brief Returns the seconds of the Retry-After header or -1 if not present or invalid.
+     */
+    int retryAfter() const;
+
+    /**
+     * @brief Returns the value usable in an If-Range header: the strong ETag or the
+     * Last-Modified date. Returns empty if there is none.
+     */
+    QString validator() const;
+  };
+
+  /**
+   * @brief Parses the headers of the last response in the given text.
+   * @param data Response headers text, as written by curl --dump-header or --include.
+   */
+  ResponseHeaders parseResponseHeaders(const QByteArray &data);
+
+  /**
+   * @brief Reads the headers of the last response in a file written by curl --dump-header.
+   * @param filename Headers file.
+   */
+  ResponseHeaders readResponseHeaders(const QString &filename);
+
+  /**
+   * @brief Returns the curl arguments to use the proxy of the given item, empty if none.
+   * @param item Item information.
+   */
+  QStringList curlProxyArguments(const ItemInformation &item);
+
+  /**
+   * @brief Returns the number of bytes of a size in curl progress meter units (k, M, G...).
+   * @param text Size text.
+   */
+  qint64 curlSizeToBytes(const QString &text);
+
   /**
    * @brief Returns the version of the curl executable or empty if failed.
    * @param exePath Path of the executable.
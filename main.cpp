@@ -27,6 +27,7 @@
 #include <QIcon>
 #include <QEventLoop>
 #include <QDebug>
+#include <QThread>
 
 // C++
 #include <iostream>
@@ -53,8 +54,17 @@ int wmain(int argc, wchar_t *argv[], wchar_t *envp[])
   QSharedMemory guard;
   guard.setKey("CurlDownloader");
 
+  const auto arguments = app.arguments().mid(1);
+
   if (!guard.create(1))
   {
+    // hand the arguments to the running instance, it can still be starting.
+    for(int i = 0; i < 10; ++i)
+    {
+      if(MainWindow::sendToRunningInstance(arguments)) exit(0);
+      QThread::msleep(200);
+    }
+
     QMessageBox msgBox;
     msgBox.setWindowIcon(QIcon(":/Downloader/download.svg"));
     msgBox.setIcon(QMessageBox::Warning);
@@ -66,6 +76,7 @@ int wmain(int argc, wchar_t *argv[], wchar_t *envp[])
  
   MainWindow application;
   application.show();
+  application.enqueueArguments(arguments);
 
   return app.exec();
 }